@@ -0,0 +1,53 @@
+#===- cmake/abnf2cpp.cmake ------------------------------------------------===//
+#*        _            __ ____                   *
+#*   __ _| |__  _ __  / _|___ \ ___ _ __  _ __   *
+#*  / _` | '_ \| '_ \| |_  __) / __| '_ \| '_ \  *
+#* | (_| | |_) | | | |  _|/ __/ (__| |_) | |_) | *
+#*  \__,_|_.__/|_| |_|_| |_____\___| .__/| .__/  *
+#*                                 |_|   |_|     *
+#===----------------------------------------------------------------------===//
+# Distributed under the MIT License.
+# See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+# SPDX-License-Identifier: MIT
+#===----------------------------------------------------------------------===//
+
+# Generates a C++ header from an ABNF grammar using the abnf2cpp tool.
+#
+#   abnf2cpp (OUTPUT <header> INPUT <abnf-file>
+#             [NAMESPACE <ns>] START <rule>... [CAPTURE <rule>...])
+#
+# The header is regenerated when either the input grammar or the tool changes.
+# Add OUTPUT to the sources of a target to make the target depend on it.
+function (abnf2cpp)
+  cmake_parse_arguments (
+    arg # prefix
+    "" # options
+    "OUTPUT;INPUT;NAMESPACE" # one-value-keywords
+    "START;CAPTURE" # multi-value-keywords
+    ${ARGN}
+  )
+  if (NOT arg_OUTPUT OR NOT arg_INPUT OR NOT arg_START)
+    message (FATAL_ERROR "abnf2cpp: OUTPUT, INPUT, and START are required")
+  endif ()
+
+  set (args )
+  if (arg_NAMESPACE)
+    list (APPEND args --namespace ${arg_NAMESPACE})
+  endif ()
+  foreach (rule ${arg_START})
+    list (APPEND args --start ${rule})
+  endforeach ()
+  foreach (rule ${arg_CAPTURE})
+    list (APPEND args --capture ${rule})
+  endforeach ()
+
+  get_filename_component (output_dir "${arg_OUTPUT}" DIRECTORY)
+  add_custom_command (
+    OUTPUT "${arg_OUTPUT}"
+    COMMAND "${CMAKE_COMMAND}" -E make_directory "${output_dir}"
+    COMMAND abnf2cpp ${args} -o "${arg_OUTPUT}" "${arg_INPUT}"
+    DEPENDS abnf2cpp "${arg_INPUT}"
+    COMMENT "Generating ${arg_OUTPUT} from ${arg_INPUT}"
+    VERBATIM
+  )
+endfunction (abnf2cpp)
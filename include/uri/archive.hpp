@@ -0,0 +1,162 @@
+//===- include/uri/archive.hpp ----------------------------*- mode: C++ -*-===//
+//*                 _     _            *
+//*   __ _ _ __ ___| |__ (_)_   _____  *
+//*  / _` | '__/ __| '_ \| \ \ / / _ \ *
+//* | (_| | | | (__| | | | |\ V /  __/ *
+//*  \__,_|_|  \___|_| |_|_| \_/ \___| *
+//*                                    *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file archive.hpp
+/// \brief A binary format for collections of parsed URIs.
+///
+/// An archive holds the text of a collection of URIs together with a
+/// fixed-width record for each which gives the boundaries of its components.
+/// It is intended to be memory-mapped: opening an archive checks only its
+/// header and the parts of an entry are produced directly from its record with
+/// views into the mapped text. Nothing is parsed.
+///
+/// The layout is as follows. All integers are unsigned and little-endian.
+///
+/// | Offset | Size       | Field                                         |
+/// |--------|------------|-----------------------------------------------|
+/// | 0      | 8          | magic: "URIPARTS"                             |
+/// | 8      | 4          | version: 1                                    |
+/// | 12     | 4          | record size: 72                               |
+/// | 16     | 8          | record count (n)                              |
+/// | 24     | 8          | text size                                     |
+/// | 32     | 72 * n     | records                                       |
+/// | 32+72n | text size  | text                                          |
+///
+/// Each record is laid out as:
+///
+/// | Offset | Size       | Field                                         |
+/// |--------|------------|-----------------------------------------------|
+/// | 0      | 8          | offset of the URI within the text             |
+/// | 8      | 4          | length of the URI                             |
+/// | 12     | 4          | flags: bit 0 is parts::path::absolute         |
+/// | 16     | 7 * 8      | offset and length (4 bytes each) of the       |
+/// |        |            | scheme, userinfo, host, port, path, query and |
+/// |        |            | fragment within the URI as in compact_parts   |
+///
+/// ~~~cpp
+/// uri::archive_writer writer;
+/// for (std::string_view const s : urls) {
+///   if (auto const p = uri::split (s)) {
+///     writer.push_back (s, *p);
+///   }
+/// }
+/// writer.write (file);
+/// ...
+/// std::span<std::byte const> const mapping = ...;  // e.g. from mmap()
+/// auto const a = uri::archive::open (mapping);
+/// if (auto const* const ar = std::get_if<uri::archive> (&a)) {
+///   std::optional<uri::parts> const p = ar->at (0);
+/// }
+/// ~~~
+
+#ifndef URI_ARCHIVE_HPP
+#define URI_ARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <variant>
+#include <vector>
+
+#include "uri/compact_parts.hpp"
+#include "uri/uri.hpp"
+
+namespace uri {
+
+enum class archive_error : int {
+  none,
+  bad_magic,
+  bad_version,
+  truncated,
+};
+
+class archive_error_category final : public std::error_category {
+public:
+  char const* name () const noexcept override;
+  std::string message (int error) const override;
+};
+std::error_code make_error_code (archive_error e);
+
+namespace details {
+
+struct archive_layout {
+  static constexpr std::string_view magic = "URIPARTS";
+  static constexpr std::uint32_t version = 1;
+  static constexpr std::size_t header_size = 32;
+  static constexpr std::size_t record_size = 72;
+};
+
+}  // end namespace details
+
+/// Accumulates the records and text of an archive.
+class archive_writer {
+public:
+  /// Appends \p source whose split result is \p p. Returns false, and leaves
+  /// the archive unchanged, if \p p cannot be represented as a compact_parts
+  /// relative to \p source.
+  bool push_back (std::string_view source, parts const& p);
+
+  /// The number of entries.
+  [[nodiscard]] std::size_t size () const noexcept { return records_.size () / details::archive_layout::record_size; }
+  [[nodiscard]] bool empty () const noexcept { return records_.empty (); }
+
+  /// Writes the archive to \p os.
+  std::ostream& write (std::ostream& os) const;
+
+private:
+  std::vector<std::byte> records_;
+  std::string text_;
+};
+
+/// A read-only view of an archive held in memory.
+class archive {
+public:
+  /// Checks the header of the archive in \p bytes. The bytes are not copied
+  /// and must outlive the archive object and any parts produced from it.
+  static std::variant<std::error_code, archive> open (std::span<std::byte const> bytes);
+
+  /// The number of entries.
+  [[nodiscard]] std::size_t size () const noexcept { return count_; }
+  [[nodiscard]] bool empty () const noexcept { return count_ == 0; }
+
+  /// Returns the text of entry \p index or std::nullopt if \p index is not
+  /// less than size() or its record does not lie within the archive's text.
+  [[nodiscard]] std::optional<std::string_view> source (std::size_t index) const noexcept;
+  /// Returns the component boundaries of entry \p index. The ranges are
+  /// offsets within source(index). If \p index is not less than size(), none
+  /// of the components is present.
+  [[nodiscard]] compact_parts bounds (std::size_t index) const noexcept;
+  /// Returns the parts of entry \p index whose strings refer directly to the
+  /// archive's bytes or std::nullopt if \p index is not less than size() or
+  /// its record is inconsistent. The path segments are stored in memory
+  /// obtained from \p resource.
+  [[nodiscard]] std::optional<parts> at (std::size_t index,
+                                         std::pmr::memory_resource* resource = std::pmr::get_default_resource ()) const;
+
+private:
+  archive (std::span<std::byte const> records, std::string_view text, std::size_t count) noexcept
+      : records_{records}, text_{text}, count_{count} {}
+
+  std::span<std::byte const> records_;
+  std::string_view text_;
+  std::size_t count_;
+};
+
+}  // end namespace uri
+
+#endif  // URI_ARCHIVE_HPP
@@ -0,0 +1,145 @@
+//===- include/uri/ascii.hpp ------------------------------*- mode: C++ -*-===//
+//*                 _ _  *
+//*   __ _ ___  ___(_|_) *
+//*  / _` / __|/ __| | | *
+//* | (_| \__ \ (__| | | *
+//*  \__,_|___/\___|_|_| *
+//*                      *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file ascii.hpp
+/// \brief Locale-independent classification of ASCII characters.
+///
+/// The character classes used by the RFC 3986 grammar are defined in terms of
+/// ASCII alone. The functions in this file use a single 256-entry table which
+/// is built at compile time. Unlike the functions declared in <cctype>, the
+/// results do not depend on the current locale and every byte with the high
+/// bit set is a member of no class.
+
+#ifndef URI_ASCII_HPP
+#define URI_ASCII_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace uri::ascii {
+
+enum char_class : std::uint16_t {
+  alpha = 1U << 0U,       // ALPHA
+  digit = 1U << 1U,       // DIGIT
+  hexdig = 1U << 2U,      // HEXDIG
+  upper = 1U << 3U,       // "A" to "Z"
+  sub_delims = 1U << 4U,  // "!" / "$" / "&" / "'" / "(" / ")" / "*" / "+" / "," / ";" / "="
+  unreserved = 1U << 5U,  // ALPHA / DIGIT / "-" / "." / "_" / "~"
+  scheme = 1U << 6U,      // ALPHA / DIGIT / "+" / "-" / "."
+  reg_name = 1U << 7U,    // unreserved / sub-delims
+  userinfo = 1U << 8U,    // unreserved / sub-delims / ":"
+  pchar = 1U << 9U,       // unreserved / sub-delims / ":" / "@"
+  query = 1U << 10U,      // pchar / "/" / "?"
+};
+
+namespace details {
+
+constexpr std::array<std::uint16_t, 256> make_char_classes () {
+  std::array<std::uint16_t, 256> table{};
+  auto const set = [&table] (char const c, unsigned const bits) {
+    auto& entry = table[static_cast<unsigned char> (c)];
+    entry = static_cast<std::uint16_t> (entry | bits);
+  };
+  // The reg-name, userinfo, pchar, and query classes (ignoring pct-encoded)
+  // are each a superset of the one before.
+  constexpr auto reg_name_up = reg_name | userinfo | pchar | query;
+  for (auto c = 'a'; c <= 'z'; ++c) {
+    set (c, alpha | scheme | unreserved | reg_name_up);
+  }
+  for (auto c = 'A'; c <= 'Z'; ++c) {
+    set (c, alpha | upper | scheme | unreserved | reg_name_up);
+  }
+  for (auto c = '0'; c <= '9'; ++c) {
+    set (c, digit | hexdig | scheme | unreserved | reg_name_up);
+  }
+  for (auto c = 'a'; c <= 'f'; ++c) {
+    set (c, hexdig);
+  }
+  for (auto c = 'A'; c <= 'F'; ++c) {
+    set (c, hexdig);
+  }
+  set ('+', scheme);
+  set ('-', scheme | unreserved | reg_name_up);
+  set ('.', scheme | unreserved | reg_name_up);
+  set ('_', unreserved | reg_name_up);
+  set ('~', unreserved | reg_name_up);
+  for (auto const c : {'!', '$', '&', '\'', '(', ')', '*', '+', ',', ';', '='}) {
+    set (c, sub_delims | reg_name_up);
+  }
+  set (':', userinfo | pchar | query);
+  set ('@', pchar | query);
+  set ('/', query);
+  set ('?', query);
+  return table;
+}
+
+inline constexpr auto char_classes = make_char_classes ();
+
+}  // end namespace details
+
+/// Returns true if \p c is a member of any of the character classes in \p cls.
+constexpr bool is (char const c, unsigned const cls) noexcept {
+  return (details::char_classes[static_cast<unsigned char> (c)] & cls) != 0U;
+}
+
+constexpr bool is_alpha (char const c) noexcept {
+  return is (c, alpha);
+}
+constexpr bool is_digit (char const c) noexcept {
+  return is (c, digit);
+}
+constexpr bool is_hexdig (char const c) noexcept {
+  return is (c, hexdig);
+}
+constexpr bool is_sub_delim (char const c) noexcept {
+  return is (c, sub_delims);
+}
+constexpr bool is_unreserved (char const c) noexcept {
+  return is (c, unreserved);
+}
+
+/// Returns true if the characters of \p str starting at \p pos form a
+/// pct-encoded triple.
+///
+/// pct-encoded   = "%" HEXDIG HEXDIG
+constexpr bool is_pct_encoded (std::string_view const str, std::size_t const pos) noexcept {
+  assert (pos < str.length ());
+  return str.length () - pos >= 3 && str[pos] == '%' && is (str[pos + 1], hexdig) && is (str[pos + 2], hexdig);
+}
+
+/// Returns true if every character of \p str is a member of the character
+/// class \p cls or is part of a pct-encoded triple.
+constexpr bool all_of (std::string_view const str, unsigned const cls) noexcept {
+  for (auto pos = std::size_t{0}; pos < str.length ();) {
+    if (is (str[pos], cls)) {
+      ++pos;
+    } else if (is_pct_encoded (str, pos)) {
+      pos += 3;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Converts an ASCII upper-case letter to lower-case. Any other value is
+/// returned unchanged.
+constexpr char to_lower (char const c) noexcept {
+  return is (c, upper) ? static_cast<char> (c - 'A' + 'a') : c;
+}
+
+}  // end namespace uri::ascii
+
+#endif  // URI_ASCII_HPP
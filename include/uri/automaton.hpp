@@ -0,0 +1,233 @@
+//===- include/uri/automaton.hpp --------------------------*- mode: C++ -*-===//
+//*              _                        _               *
+//*   __ _ _   _| |_ ___  _ __ ___   __ _| |_ ___  _ __   *
+//*  / _` | | | | __/ _ \| '_ ` _ \ / _` | __/ _ \| '_ \  *
+//* | (_| | |_| | || (_) | | | | | | (_| | || (_) | | | | *
+//*  \__,_|\__,_|\__\___/|_| |_| |_|\__,_|\__\___/|_| |_| *
+//*                                                       *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file automaton.hpp
+/// \brief Run-time support for recognizers generated by abnf2cpp.
+///
+/// The abnf2cpp tool compiles a (non-recursive) ABNF grammar into two
+/// automata for each start rule:
+///
+/// - A minimal deterministic finite automaton (DFA). recognize() uses this to
+///   decide whether a string matches the rule with one table lookup per input
+///   character.
+/// - A non-deterministic automaton (NFA) program whose instructions mark the
+///   start and end of selected rules. parse() runs this program as a Pike VM,
+///   which considers every way in which the grammar could match the input in
+///   a single left-to-right pass. When the complete input is matched, the
+///   captured rules are reported to a hook function.
+///
+/// Where the grammar is ambiguous, parse() chooses the match that prefers
+/// earlier alternatives and longer repetitions, considered from left to right.
+/// Unlike the ordered choice of the grammar templates in grammar.hpp, a
+/// preferred alternative which cannot lead to a complete match is always
+/// abandoned in favor of one which can.
+
+#ifndef URI_AUTOMATON_HPP
+#define URI_AUTOMATON_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace uri::automaton {
+
+/// A set of 256 bits, one for each possible value of a char.
+using char_set = std::array<std::uint64_t, 4>;
+
+constexpr bool contains (char_set const& set, char const c) noexcept {
+  auto const index = static_cast<unsigned char> (c);
+  return (set[index / 64U] >> (index % 64U)) & 1U;
+}
+
+/// The tables describing a DFA.
+///
+/// Input characters are first mapped to an equivalence class using `classes`.
+/// The next state is then found at `transitions[state * num_classes + class]`.
+/// State 0 is the dead state from which no match is possible; state 1 is the
+/// initial state.
+struct dfa {
+  std::span<std::uint8_t const, 256> classes;
+  std::size_t num_classes;
+  std::span<std::uint16_t const> transitions;
+  std::span<bool const> accepting;
+};
+
+/// Returns true if \p input is matched in its entirety by \p machine.
+constexpr bool recognize (dfa const& machine, std::string_view const input) noexcept {
+  auto state = std::size_t{1};
+  for (auto const c : input) {
+    state = machine.transitions[state * machine.num_classes + machine.classes[static_cast<unsigned char> (c)]];
+    if (state == 0) {
+      return false;
+    }
+  }
+  return machine.accepting[state];
+}
+
+enum class opcode : std::uint8_t {
+  set,    ///< Consume one character which is a member of sets[arg0].
+  split,  ///< Continue at both arg0 and arg1, preferring arg0.
+  jump,   ///< Continue at arg0.
+  open,   ///< Record the start of capture arg0.
+  close,  ///< Record the end of capture arg0.
+  match,  ///< Succeed if the input has been consumed.
+};
+
+struct instruction {
+  opcode op;
+  std::uint16_t arg0;
+  std::uint16_t arg1;
+};
+
+/// An NFA program.
+struct program {
+  std::span<instruction const> code;
+  std::span<char_set const> sets;
+  std::size_t num_captures;
+};
+
+namespace details {
+
+/// A capture event. The events form a tree in which each thread of the VM
+/// refers to the most recent event on its path.
+struct event {
+  std::uint32_t prev;  ///< The index of the previous event or no_event.
+  std::uint16_t capture;
+  bool close;
+  std::size_t pos;
+};
+inline constexpr auto no_event = std::uint32_t{0xFFFFFFFF};
+
+struct thread {
+  std::uint16_t pc;
+  std::uint32_t last_event;
+};
+
+class pike_vm {
+public:
+  explicit pike_vm (program const& prog)
+      : prog_{prog}, visited_ (prog.code.size (), std::size_t{0}), current_{}, next_{} {}
+
+  /// Runs the program against \p input. Returns true if the input is matched,
+  /// in which case \p last_event is set to the index of the last event on the
+  /// winning path (which may be no_event).
+  bool run (std::string_view const input, std::uint32_t& last_event) {
+    this->add_thread (current_, {0, no_event}, 0);
+    for (auto pos = std::size_t{0}; pos < input.length (); ++pos) {
+      if (current_.empty ()) {
+        return false;
+      }
+      ++generation_;
+      auto const c = input[pos];
+      for (auto const& t : current_) {
+        auto const& inst = prog_.code[t.pc];
+        if (inst.op == opcode::set && contains (prog_.sets[inst.arg0], c)) {
+          this->add_thread (next_, {static_cast<std::uint16_t> (t.pc + 1U), t.last_event}, pos + 1);
+        }
+      }
+      std::swap (current_, next_);
+      next_.clear ();
+    }
+    for (auto const& t : current_) {
+      if (prog_.code[t.pc].op == opcode::match) {
+        last_event = t.last_event;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  [[nodiscard]] std::vector<event> const& events () const noexcept { return events_; }
+
+private:
+  /// Follows the non-consuming instructions reachable from \p t, adding the
+  /// threads which stop at a set or match instruction to \p list in priority
+  /// order.
+  void add_thread (std::vector<thread>& list, thread const t, std::size_t const pos) {
+    stack_.push_back (t);
+    while (!stack_.empty ()) {
+      auto th = stack_.back ();
+      stack_.pop_back ();
+      for (;;) {
+        if (visited_[th.pc] == generation_ + 1) {
+          break;
+        }
+        visited_[th.pc] = generation_ + 1;
+        auto const& inst = prog_.code[th.pc];
+        switch (inst.op) {
+        case opcode::jump: th.pc = inst.arg0; continue;
+        case opcode::split:
+          stack_.push_back ({inst.arg1, th.last_event});
+          th.pc = inst.arg0;
+          continue;
+        case opcode::open:
+        case opcode::close:
+          events_.push_back ({th.last_event, inst.arg0, inst.op == opcode::close, pos});
+          th.last_event = static_cast<std::uint32_t> (events_.size () - 1U);
+          ++th.pc;
+          continue;
+        case opcode::set:
+        case opcode::match: list.push_back (th); break;
+        }
+        break;
+      }
+    }
+  }
+
+  program const& prog_;
+  std::vector<std::size_t> visited_;
+  std::size_t generation_ = 0;
+  std::vector<thread> current_;
+  std::vector<thread> next_;
+  std::vector<thread> stack_;
+  std::vector<event> events_;
+};
+
+}  // end namespace details
+
+/// Matches \p input against \p prog. If the complete input is matched,
+/// \p hook is called for each captured rule with the capture number and the
+/// matched text, and the function returns true. The calls are made in the
+/// order in which the captures end; a rule is therefore reported after any
+/// captured rules that it contains.
+template <typename Hook>
+bool parse (program const& prog, std::string_view const input, Hook hook) {
+  details::pike_vm vm{prog};
+  auto last = details::no_event;
+  if (!vm.run (input, last)) {
+    return false;
+  }
+  auto const& events = vm.events ();
+  std::vector<details::event const*> path;
+  for (auto index = last; index != details::no_event; index = events[index].prev) {
+    path.push_back (&events[index]);
+  }
+  std::vector<std::size_t> open (prog.num_captures, std::size_t{0});
+  for (auto it = path.rbegin (); it != path.rend (); ++it) {
+    auto const& ev = **it;
+    if (!ev.close) {
+      open[ev.capture] = ev.pos;
+    } else {
+      assert (open[ev.capture] <= ev.pos);
+      hook (static_cast<std::size_t> (ev.capture), input.substr (open[ev.capture], ev.pos - open[ev.capture]));
+    }
+  }
+  return true;
+}
+
+}  // end namespace uri::automaton
+
+#endif  // URI_AUTOMATON_HPP
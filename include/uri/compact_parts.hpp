@@ -0,0 +1,124 @@
+//===- include/uri/compact_parts.hpp ----------------------*- mode: C++ -*-===//
+//*                                       _                      _        *
+//*   ___ ___  _ __ ___  _ __   __ _  ___| |_   _ __   __ _ _ __| |_ ___  *
+//*  / __/ _ \| '_ ` _ \| '_ \ / _` |/ __| __| | '_ \ / _` | '__| __/ __| *
+//* | (_| (_) | | | | | | |_) | (_| | (__| |_  | |_) | (_| | |  | |_\__ \ *
+//*  \___\___/|_| |_| |_| .__/ \__,_|\___|\__| | .__/ \__,_|_|   \__|___/ *
+//*                     |_|                    |_|                        *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file compact_parts.hpp
+/// \brief A compact representation of the parts of a URI.
+///
+/// A parts object holds string views together with a vector of path segments.
+/// Where many parsed URIs must be kept, compact_parts instead records each
+/// component as a 32-bit offset and length within the source string from which
+/// it was split. Absent components are represented by a sentinel offset rather
+/// than std::optional and the path is recorded as a single range from which the
+/// segments are recovered on demand.
+///
+/// ~~~cpp
+/// std::string const source = "http://example.com/a/b?q";
+/// if (auto const p = uri::split (source)) {
+///   std::optional<uri::compact_parts> const c = uri::compact (*p, source);
+///   ...
+///   uri::parts const q = uri::expand (*c, source);  // q == *p
+/// }
+/// ~~~
+
+#ifndef URI_COMPACT_PARTS_HPP
+#define URI_COMPACT_PARTS_HPP
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+#include "uri/uri.hpp"
+
+namespace uri {
+
+struct compact_parts {
+  /// A component of a URI expressed as an offset and length within the source
+  /// string.
+  struct range {
+    /// The offset used to indicate that the component is not present.
+    static constexpr auto absent = std::uint32_t{0xFFFFFFFF};
+
+    std::uint32_t offset = absent;
+    std::uint32_t length = 0;
+
+    [[nodiscard]] constexpr bool has_value () const noexcept { return offset != absent; }
+    /// Returns the text of this component within \p source or std::nullopt if
+    /// the component is not present.
+    [[nodiscard]] constexpr std::optional<std::string_view> view (std::string_view const source) const noexcept {
+      if (!this->has_value ()) {
+        return std::nullopt;
+      }
+      assert (offset <= source.length () && length <= source.length () - offset);
+      return source.substr (offset, length);
+    }
+
+    bool operator== (range const& rhs) const noexcept = default;
+  };
+
+  range scheme;
+  range userinfo;
+  range host;  ///< Present if and only if the URI has an authority.
+  range port;
+  /// The path segments and the "/" characters that separate them. Absent if
+  /// there are no segments.
+  range path;
+  range query;
+  range fragment;
+  bool absolute = false;  ///< Corresponds to parts::path::absolute.
+
+  [[nodiscard]] constexpr bool has_authority () const noexcept { return host.has_value (); }
+  /// Returns the text of the authority (userinfo, host and port together with
+  /// their delimiters but without the leading "//") within \p source or
+  /// std::nullopt if there is no authority.
+  [[nodiscard]] constexpr std::optional<std::string_view> authority (std::string_view const source) const noexcept {
+    if (!this->has_authority ()) {
+      return std::nullopt;
+    }
+    auto const first = userinfo.has_value () ? userinfo.offset : host.offset;
+    auto const last = port.has_value () ? port.offset + port.length : host.offset + host.length;
+    return source.substr (first, last - first);
+  }
+
+  bool operator== (compact_parts const& rhs) const noexcept = default;
+};
+
+namespace details {
+
+/// Pointers to each of the range members of compact_parts in the order in
+/// which they are declared.
+inline constexpr auto compact_parts_members =
+    std::array{&compact_parts::scheme, &compact_parts::userinfo, &compact_parts::host,    &compact_parts::port,
+               &compact_parts::path,   &compact_parts::query,    &compact_parts::fragment};
+
+}  // end namespace details
+
+/// Creates the compact representation of \p p whose strings refer to \p
+/// source. Returns std::nullopt if \p p cannot be represented: that is, if any
+/// of its non-empty strings lie outside \p source, if its path segments are not
+/// contiguous and separated by "/", or if \p source is too long to be
+/// addressed using 32-bit offsets. The parts produced by split() and
+/// split_reference() can always be represented.
+std::optional<compact_parts> compact (parts const& p, std::string_view source);
+
+/// Converts \p c back to parts whose strings refer to \p source. For parts
+/// \p p for which compact(p, source) succeeds, expand(*compact(p, source),
+/// source) == p. The path segments of the result are stored in memory
+/// obtained from \p resource.
+parts expand (compact_parts const& c, std::string_view source,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+
+}  // end namespace uri
+
+#endif  // URI_COMPACT_PARTS_HPP
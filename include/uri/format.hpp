@@ -0,0 +1,196 @@
+//===- include/uri/format.hpp -----------------------------*- mode: C++ -*-===//
+//*   __                            _    *
+//*  / _| ___  _ __ _ __ ___   __ _| |_  *
+//* | |_ / _ \| '__| '_ ` _ \ / _` | __| *
+//* |  _| (_) | |  | | | | | | (_| | |_  *
+//* |_|  \___/|_|  |_| |_| |_|\__,_|\__| *
+//*                                      *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file format.hpp
+/// \brief std::formatter specializations for parts, parts::path and
+///   parts::authority.
+///
+/// The formatters write directly to the format context's output iterator:
+/// no intermediate string is composed. The format specification of a parts
+/// object is a sequence of letters which select the components that are
+/// written:
+///
+/// | Letter | Components                              |
+/// | ------ | --------------------------------------- |
+/// | s      | scheme                                  |
+/// | u      | userinfo                                |
+/// | h      | host                                    |
+/// | n      | port (number)                           |
+/// | a      | authority (the same as "uhn")           |
+/// | p      | path                                    |
+/// | q      | query                                   |
+/// | f      | fragment                                |
+/// | o      | origin (the same as "shn")              |
+///
+/// An empty specification selects every component.
+///
+/// ~~~cpp
+/// auto const p = *uri::split ("https://user@example.com:8080/a/b?q=1#top");
+/// std::format ("{}", p);   // "https://user@example.com:8080/a/b?q=1#top"
+/// std::format ("{:o}", p);  // "https://example.com:8080"
+/// std::format ("{:pq}", p); // "/a/b?q=1"
+/// ~~~
+///
+/// An authority accepts the letters u, h, n and a; it is written without the
+/// leading "//". A path accepts only "p" or the empty specification.
+///
+/// The std::formatter specializations are available only if the standard
+/// library provides <format>, in which case URI_HAVE_FORMAT is defined as 1.
+/// If the build defines URI_HAVE_FMT as 1 (the CMake build does so when it is
+/// configured with URI_FMT), equivalent fmt::formatter specializations are
+/// also provided.
+
+#ifndef URI_FORMAT_HPP
+#define URI_FORMAT_HPP
+
+#include <optional>
+#include <string_view>
+#include <version>
+
+#include "uri/uri.hpp"
+
+#if defined(__cpp_lib_format) && __cpp_lib_format >= 201907L
+#include <format>
+#define URI_HAVE_FORMAT 1
+#else
+#define URI_HAVE_FORMAT 0
+#endif
+
+#ifndef URI_HAVE_FMT
+#define URI_HAVE_FMT 0
+#endif
+#if URI_HAVE_FMT
+#include <fmt/format.h>
+#endif
+
+namespace uri::details {
+
+/// Returns the components named by the letters of a format specification
+/// or std::nullopt if \p spec contains a letter that does not name one of the
+/// components in \p allowed. An empty \p spec selects all of \p allowed.
+constexpr std::optional<field_mask> format_fields (std::string_view const spec, field_mask const allowed) noexcept {
+  if (spec.empty ()) {
+    return allowed;
+  }
+  auto result = field_mask::none;
+  for (auto const c : spec) {
+    auto f = field_mask::none;
+    switch (c) {
+    case 's': f = field_mask::scheme; break;
+    case 'u': f = field_mask::userinfo; break;
+    case 'h': f = field_mask::host; break;
+    case 'n': f = field_mask::port; break;
+    case 'a': f = field_mask::authority; break;
+    case 'p': f = field_mask::path; break;
+    case 'q': f = field_mask::query; break;
+    case 'f': f = field_mask::fragment; break;
+    case 'o': f = field_mask::scheme | field_mask::host | field_mask::port; break;
+    default: return std::nullopt;
+    }
+    if ((f & allowed) != f) {
+      return std::nullopt;
+    }
+    result = result | f;
+  }
+  return result;
+}
+
+/// Parses the specification of a URI formatter: the characters between the
+/// start of \p ctx and the closing brace. Throws \p Error if the specification
+/// is not valid.
+template <typename Error, typename ParseContext>
+constexpr field_mask parse_format_fields (ParseContext& ctx, field_mask const allowed) {
+  auto const first = ctx.begin ();
+  auto last = first;
+  while (last != ctx.end () && *last != '}') {
+    ++last;
+  }
+  auto const fields = format_fields (std::string_view{first, last}, allowed);
+  if (!fields) {
+    throw Error ("invalid URI format specification");
+  }
+  ctx.advance_to (last);
+  return *fields;
+}
+
+/// The implementation shared by the std::formatter and fmt::formatter
+/// specializations for parts. \p Error is the type of the exception thrown
+/// for an invalid format specification.
+template <typename Error>
+class parts_formatter {
+public:
+  template <typename ParseContext> constexpr auto parse (ParseContext& ctx) {
+    fields_ = parse_format_fields<Error> (ctx, field_mask::all);
+    return ctx.begin ();
+  }
+  template <typename FormatContext> auto format (parts const& p, FormatContext& ctx) const {
+    return compose_to (p, fields_, ctx.out ());
+  }
+
+private:
+  field_mask fields_ = field_mask::all;
+};
+
+/// The implementation shared by the formatters for parts::authority.
+template <typename Error>
+class authority_formatter {
+public:
+  template <typename ParseContext> constexpr auto parse (ParseContext& ctx) {
+    fields_ = parse_format_fields<Error> (ctx, field_mask::authority);
+    return ctx.begin ();
+  }
+  template <typename FormatContext> auto format (struct parts::authority const& auth, FormatContext& ctx) const {
+    return compose_authority (auth, fields_, ctx.out ());
+  }
+
+private:
+  field_mask fields_ = field_mask::authority;
+};
+
+/// The implementation shared by the formatters for parts::path.
+template <typename Error>
+class path_formatter {
+public:
+  template <typename ParseContext> constexpr auto parse (ParseContext& ctx) {
+    (void)parse_format_fields<Error> (ctx, field_mask::path);
+    return ctx.begin ();
+  }
+  template <typename FormatContext> auto format (struct parts::path const& path, FormatContext& ctx) const {
+    return compose_path (path, ctx.out ());
+  }
+};
+
+}  // end namespace uri::details
+
+#if URI_HAVE_FORMAT
+
+template <>
+struct std::formatter<uri::parts> : uri::details::parts_formatter<std::format_error> {};
+template <>
+struct std::formatter<struct uri::parts::authority> : uri::details::authority_formatter<std::format_error> {};
+template <>
+struct std::formatter<struct uri::parts::path> : uri::details::path_formatter<std::format_error> {};
+
+#endif  // URI_HAVE_FORMAT
+
+#if URI_HAVE_FMT
+
+template <>
+struct fmt::formatter<uri::parts> : uri::details::parts_formatter<fmt::format_error> {};
+template <>
+struct fmt::formatter<struct uri::parts::authority> : uri::details::authority_formatter<fmt::format_error> {};
+template <>
+struct fmt::formatter<struct uri::parts::path> : uri::details::path_formatter<fmt::format_error> {};
+
+#endif  // URI_HAVE_FMT
+
+#endif  // URI_FORMAT_HPP
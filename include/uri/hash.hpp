@@ -0,0 +1,121 @@
+//===- include/uri/hash.hpp -------------------------------*- mode: C++ -*-===//
+//*  _               _      *
+//* | |__   __ _ ___| |__   *
+//* | '_ \ / _` / __| '_ \  *
+//* | | | | (_| \__ \ | | | *
+//* |_| |_|\__,_|___/_| |_| *
+//*                         *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file hash.hpp
+/// \brief Hashing of parts for use in unordered containers.
+///
+/// The hash of a parts object is computed directly from its components: no
+/// text is composed. Each component contributes a tag that identifies it and
+/// records whether it is present, followed by its length and its characters.
+/// The encoding of the boundaries between components is therefore
+/// unambiguous. The hashes are consistent with the corresponding operator==:
+/// in particular, the path's absolute flag does not contribute to the hash of
+/// parts which have an authority. Hash values are not stable between builds or
+/// platforms and must not be persisted.
+///
+/// normalized_hash and normalized_equal treat URIs which are equivalent under
+/// the normalizations performed by normalize() as equal:
+///
+/// ~~~cpp
+/// std::unordered_set<uri::parts, uri::normalized_hash, uri::normalized_equal> s;
+/// s.insert (*uri::split ("HTTP://Example.COM/a/./b"));
+/// assert (s.contains (*uri::split ("http://example.com/a/b")));
+/// ~~~
+
+#ifndef URI_HASH_HPP
+#define URI_HASH_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+#include "uri/uri.hpp"
+
+namespace uri {
+
+namespace details {
+
+inline constexpr auto hash_k0 = std::uint64_t{0x9E3779B97F4A7C15};
+inline constexpr auto hash_k1 = std::uint64_t{0xBF58476D1CE4E5B9};
+
+/// The finalizer from MurmurHash3. Every bit of the input affects every bit of
+/// the result.
+constexpr std::uint64_t hash_mix (std::uint64_t h) noexcept {
+  h ^= h >> 33U;
+  h *= 0xFF51AFD7ED558CCD;
+  h ^= h >> 33U;
+  h *= 0xC4CEB9FE1A85EC53;
+  h ^= h >> 33U;
+  return h;
+}
+
+/// Hashes the length and characters of \p str starting from \p seed. The
+/// string is consumed eight bytes at a time.
+inline std::uint64_t hash_bytes (std::string_view const str, std::uint64_t const seed) noexcept {
+  auto const step = [] (std::uint64_t const h, std::uint64_t const word) {
+    return std::rotl (h ^ (word * hash_k1), 29) * hash_k0;
+  };
+  auto h = seed ^ (str.length () * hash_k0);
+  auto const* p = str.data ();
+  auto remaining = str.length ();
+  for (; remaining >= sizeof (std::uint64_t); remaining -= sizeof (std::uint64_t), p += sizeof (std::uint64_t)) {
+    std::uint64_t word;
+    std::memcpy (&word, p, sizeof (word));
+    h = step (h, word);
+  }
+  if (remaining > 0) {
+    auto word = std::uint64_t{0};
+    std::memcpy (&word, p, remaining);
+    h = step (h, word);
+  }
+  return hash_mix (h);
+}
+
+}  // end namespace details
+
+std::uint64_t hash (struct parts::authority const& auth) noexcept;
+std::uint64_t hash (struct parts::path const& path) noexcept;
+std::uint64_t hash (parts const& p) noexcept;
+
+/// A hash function for use with unordered containers which is equal for
+/// parts that are equivalent after normalize().
+struct normalized_hash {
+  std::size_t operator() (parts const& p) const;
+};
+/// The equality predicate which accompanies normalized_hash.
+struct normalized_equal {
+  bool operator() (parts const& lhs, parts const& rhs) const;
+};
+
+}  // end namespace uri
+
+template <>
+struct std::hash<struct uri::parts::authority> {
+  std::size_t operator() (struct uri::parts::authority const& auth) const noexcept {
+    return static_cast<std::size_t> (uri::hash (auth));
+  }
+};
+template <>
+struct std::hash<struct uri::parts::path> {
+  std::size_t operator() (struct uri::parts::path const& path) const noexcept {
+    return static_cast<std::size_t> (uri::hash (path));
+  }
+};
+template <>
+struct std::hash<uri::parts> {
+  std::size_t operator() (uri::parts const& p) const noexcept { return static_cast<std::size_t> (uri::hash (p)); }
+};
+
+#endif  // URI_HASH_HPP
@@ -0,0 +1,97 @@
+//===- include/uri/join_context.hpp -----------------------*- mode: C++ -*-===//
+//*    _       _                         _            _    *
+//*   (_) ___ (_)_ __     ___ ___  _ __ | |_ _____  _| |_  *
+//*   | |/ _ \| | '_ \   / __/ _ \| '_ \| __/ _ \ \/ / __| *
+//*   | | (_) | | | | | | (_| (_) | | | | ||  __/>  <| |_  *
+//*  _/ |\___/|_|_| |_|  \___\___/|_| |_|\__\___/_/\_\\__| *
+//* |__/                                                   *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file join_context.hpp
+/// \brief Resolves many URI references against a single base URI.
+///
+/// join() splits its base URI on every call and, for a relative-path
+/// reference, copies the base path's segments to build the merged path. When
+/// a crawler resolves all of the links found on a page, that work is the same
+/// for each link. A join_context splits the base once, computes the prefix of
+/// every merged path ahead of time, and resolves each reference into a parts
+/// object supplied by the caller. The caller can reuse that object, along
+/// with its path storage, for the next reference:
+///
+/// ~~~cpp
+/// auto const ctx = uri::join_context::make ("http://example.com/a/b/c");
+/// uri::parts target;
+/// for (std::string_view const link : links) {
+///   if (ctx->join (link, target)) {
+///     std::string const url = uri::compose (target);
+///     ...
+///   }
+/// }
+/// ~~~
+///
+/// The results are identical to those of join(). Like those of join(), they
+/// refer to the text of both the base and the reference, and that text must
+/// outlive them.
+
+#ifndef URI_JOIN_CONTEXT_HPP
+#define URI_JOIN_CONTEXT_HPP
+
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+#include "uri/parts.hpp"
+#include "uri/uri.hpp"
+
+namespace uri {
+
+class join_context {
+public:
+  /// Prepares to resolve references against \p base. The merged-path prefix
+  /// is stored in memory obtained from \p resource.
+  explicit join_context (parts const& base, bool strict = true,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+  /// Splits \p base and prepares to resolve references against it. Returns
+  /// std::nullopt if \p base is not a valid URI.
+  static std::optional<join_context> make (std::string_view base, bool strict = true,
+                                           std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+
+  /// The base URI.
+  [[nodiscard]] constexpr parts const& base () const noexcept { return base_; }
+  /// True if the scheme of a reference is always honored. See join().
+  [[nodiscard]] constexpr bool strict () const noexcept { return strict_; }
+
+  /// Resolves \p reference and stores the target URI in \p target. The path
+  /// segments are stored in \p target's existing storage.
+  void join (parts const& reference, parts& target) const;
+  /// Splits \p reference, resolves it, and stores the target URI in \p target.
+  /// Returns false if \p reference is not a valid URI reference, in which case
+  /// the value of \p target is unspecified.
+  bool join (std::string_view reference, parts& target) const;
+
+  /// Returns the target URI for \p reference. Its path segments are stored in
+  /// memory obtained from \p resource.
+  [[nodiscard]] parts join (parts const& reference,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource ()) const;
+  [[nodiscard]] std::optional<parts> join (
+      std::string_view reference, std::pmr::memory_resource* resource = std::pmr::get_default_resource ()) const;
+
+private:
+  /// Transforms \p target, which holds a reference, into its target URI.
+  void resolve (parts& target) const;
+
+  parts base_;
+  /// The segments which precede those of a relative-path reference in the
+  /// merged path (RFC 3986, section 5.2.3).
+  parts::path::segments_type prefix_;
+  /// True if the merged path is absolute.
+  bool prefix_absolute_ = false;
+  bool strict_ = true;
+};
+
+}  // end namespace uri
+
+#endif  // URI_JOIN_CONTEXT_HPP
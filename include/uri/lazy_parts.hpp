@@ -0,0 +1,132 @@
+//===- include/uri/lazy_parts.hpp -------------------------*- mode: C++ -*-===//
+//*  _                                    _        *
+//* | | __ _ _____   _   _ __   __ _ _ __| |_ ___  *
+//* | |/ _` |_  / | | | | '_ \ / _` | '__| __/ __| *
+//* | | (_| |/ /| |_| | | |_) | (_| | |  | |_\__ \ *
+//* |_|\__,_/___|\__, | | .__/ \__,_|_|   \__|___/ *
+//*              |___/  |_|                        *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file lazy_parts.hpp
+/// \brief Splits a URI into its components without segmenting its path.
+///
+/// split() validates every component and breaks the path into segments before
+/// returning. Consumers that look at only one or two components (routing on
+/// the host, for example) pay for work whose results they discard.
+/// split_lazy() instead records only the boundaries of each component. A
+/// component is validated the first time that its validity is queried and the
+/// path is broken into segments the first time that it is requested.
+///
+/// ~~~cpp
+/// if (auto const p = uri::split_lazy ("http://example.com/a/b/c?q")) {
+///   if (p->valid (uri::parts_field::host)) {
+///     std::string_view const host = *p->host ();  // "example.com"
+///     ...
+///   }
+/// }
+/// ~~~
+///
+/// The results are cached within the lazy_parts object so, although the member
+/// functions are const, an object must not be shared between threads without
+/// synchronization.
+
+#ifndef URI_LAZY_PARTS_HPP
+#define URI_LAZY_PARTS_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+#include "uri/compact_parts.hpp"
+#include "uri/parts.hpp"
+#include "uri/uri.hpp"
+
+namespace uri {
+
+class lazy_parts {
+public:
+  /// Records the boundaries \p bounds of the components of \p source. Path
+  /// segments are allocated from \p resource when they are materialized.
+  lazy_parts (std::string_view const source, compact_parts const& bounds, bool const reference,
+              std::pmr::memory_resource* const resource) noexcept
+      : source_{source}, bounds_{bounds}, reference_{reference}, resource_{resource} {}
+
+  /// The string from which this object was split.
+  [[nodiscard]] constexpr std::string_view source () const noexcept { return source_; }
+  /// The component boundaries.
+  [[nodiscard]] constexpr compact_parts const& bounds () const noexcept { return bounds_; }
+
+  /// \name Component accessors
+  /// These functions return the text of each component or std::nullopt if it
+  /// is not present. The text is not validated: use valid() to check it.
+  ///@{
+  [[nodiscard]] std::optional<std::string_view> scheme () const noexcept { return bounds_.scheme.view (source_); }
+  [[nodiscard]] std::optional<std::string_view> userinfo () const noexcept {
+    return bounds_.userinfo.view (source_);
+  }
+  [[nodiscard]] std::optional<std::string_view> host () const noexcept { return bounds_.host.view (source_); }
+  [[nodiscard]] std::optional<std::string_view> port () const noexcept { return bounds_.port.view (source_); }
+  [[nodiscard]] std::optional<std::string_view> query () const noexcept { return bounds_.query.view (source_); }
+  [[nodiscard]] std::optional<std::string_view> fragment () const noexcept {
+    return bounds_.fragment.view (source_);
+  }
+  [[nodiscard]] bool has_authority () const noexcept { return bounds_.has_authority (); }
+  ///@}
+
+  /// Returns the path, breaking it into segments on the first call.
+  [[nodiscard]] struct parts::path const& path () const;
+
+  /// Returns true if \p field is syntactically valid. A field that is not
+  /// present is valid. The userinfo, host and port fields are validated
+  /// together.
+  [[nodiscard]] bool valid (parts_field field) const;
+  /// Returns true if every component is valid: that is, if split() (or
+  /// split_reference() for an object produced by split_reference_lazy())
+  /// would succeed for the same input.
+  [[nodiscard]] bool valid () const;
+
+  /// Validates every component and returns the equivalent parts object or
+  /// std::nullopt if any component is invalid. For any input \p s,
+  /// split_lazy(s)->to_parts() == split(s).
+  [[nodiscard]] std::optional<parts> to_parts () const;
+
+private:
+  /// Returns the bit used in checked_ and valid_ to record the state of \p
+  /// field.
+  static constexpr std::uint8_t field_bit (parts_field const field) noexcept {
+    // The components of the authority are validated together.
+    auto const f = field == parts_field::userinfo || field == parts_field::port ? parts_field::host : field;
+    return static_cast<std::uint8_t> (1U << static_cast<unsigned> (f));
+  }
+  [[nodiscard]] bool check (parts_field field) const;
+
+  std::string_view source_;
+  compact_parts bounds_;
+  bool reference_;
+  std::pmr::memory_resource* resource_;
+  /// The fields whose validity has been established.
+  mutable std::uint8_t checked_ = 0;
+  /// The fields that have been found to be valid.
+  mutable std::uint8_t valid_ = 0;
+  /// The path once it has been broken into segments.
+  mutable std::optional<struct parts::path> path_;
+};
+
+/// Records the boundaries of the components of the URI \p in following the
+/// regular expression of RFC 3986 Appendix B. Only the structure of the input
+/// is examined: the components are validated on demand. Returns std::nullopt
+/// if \p in has no scheme or is too long to be addressed using 32-bit offsets.
+/// Path segments are allocated from \p resource when they are materialized.
+std::optional<lazy_parts> split_lazy (std::string_view in,
+                                      std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+/// As split_lazy() but \p in may be either a URI or a relative reference.
+std::optional<lazy_parts> split_reference_lazy (
+    std::string_view in, std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+
+}  // end namespace uri
+
+#endif  // URI_LAZY_PARTS_HPP
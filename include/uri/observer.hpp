@@ -0,0 +1,111 @@
+//===- include/uri/observer.hpp ---------------------------*- mode: C++ -*-===//
+//*        _                                   *
+//*   ___ | |__  ___  ___ _ ____   _____ _ __  *
+//*  / _ \| '_ \/ __|/ _ \ '__\ \ / / _ \ '__| *
+//* | (_) | |_) \__ \  __/ |   \ V /  __/ |    *
+//*  \___/|_.__/|___/\___|_|    \_/ \___|_|    *
+//*                                            *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file observer.hpp
+/// \brief A hook which reports the evaluation of each named grammar production.
+///
+/// The hook is selected at compile time by defining URI_OBSERVE to a non-zero
+/// value (the URI_OBSERVE CMake option does this). When it is not enabled, the
+/// grammar contains no trace of it. When it is enabled, an observer object may
+/// be installed for the calling thread with set_production_observer().
+
+#ifndef URI_OBSERVER_HPP
+#define URI_OBSERVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <string_view>
+
+#ifndef URI_OBSERVE
+#define URI_OBSERVE 0
+#endif
+
+namespace uri {
+
+inline constexpr bool observe_productions = URI_OBSERVE != 0;
+
+/// The base class for objects which are told about the evaluation of named
+/// grammar productions.
+class production_observer {
+public:
+  production_observer () noexcept = default;
+  production_observer (production_observer const&) = default;
+  production_observer (production_observer&&) noexcept = default;
+  virtual ~production_observer () noexcept;
+
+  production_observer& operator= (production_observer const&) = default;
+  production_observer& operator= (production_observer&&) noexcept = default;
+
+  /// Called each time that the production \p name has been evaluated.
+  ///
+  /// \param name  The name of the production.
+  /// \param success  True if the production matched.
+  /// \param length  If \p success is true, the number of characters consumed by
+  ///   the match. Otherwise, 0.
+  virtual void evaluated (std::string_view name, bool success, std::size_t length) = 0;
+};
+
+/// Installs \p observer as the production observer for the calling thread and
+/// returns the previous observer. Passing nullptr removes the observer. This
+/// function has no effect unless observe_productions is true.
+production_observer* set_production_observer (production_observer* observer) noexcept;
+
+namespace details {
+
+production_observer* get_production_observer () noexcept;
+
+inline void production_evaluated (std::string_view const name, bool const success, std::size_t const length) {
+  if constexpr (observe_productions) {
+    if (auto* const observer = get_production_observer ()) {
+      observer->evaluated (name, success, length);
+    }
+  } else {
+    (void)name;
+    (void)success;
+    (void)length;
+  }
+}
+
+}  // end namespace details
+
+/// The counters maintained for each production by production_counters.
+struct production_stats {
+  std::uint64_t invocations = 0;  ///< The number of times that the production was evaluated.
+  std::uint64_t successes = 0;    ///< The number of evaluations which matched.
+  std::uint64_t backtracks = 0;   ///< The number of evaluations which failed, forcing the caller to backtrack.
+  std::uint64_t bytes = 0;        ///< The total number of characters consumed by successful evaluations.
+};
+
+/// An observer which keeps a set of counters for each production.
+class production_counters final : public production_observer {
+public:
+  using container = std::map<std::string, production_stats, std::less<>>;
+
+  void evaluated (std::string_view name, bool success, std::size_t length) override;
+
+  [[nodiscard]] container const& stats () const noexcept { return stats_; }
+  void clear () noexcept { stats_.clear (); }
+
+private:
+  container stats_;
+};
+
+/// Writes a table of production counters to \p os, one line per production.
+std::ostream& operator<< (std::ostream& os, production_counters const& counters);
+
+}  // end namespace uri
+
+#endif  // URI_OBSERVER_HPP
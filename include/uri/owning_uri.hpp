@@ -0,0 +1,136 @@
+//===- include/uri/owning_uri.hpp -------------------------*- mode: C++ -*-===//
+//*                      _                          _  *
+//*   _____      ___ __ (_)_ __   __ _   _   _ _ __(_) *
+//*  / _ \ \ /\ / / '_ \| | '_ \ / _` | | | | | '__| | *
+//* | (_) \ V  V /| | | | | | | | (_| | | |_| | |  | | *
+//*  \___/ \_/\_/ |_| |_|_|_| |_|\__, |  \__,_|_|  |_| *
+//*                              |___/                 *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file owning_uri.hpp
+/// \brief An owning URI value type.
+///
+/// The strings in a parts object refer to the text from which it was split
+/// and dangle once that text is destroyed. An owning_uri instead owns its
+/// text. The text and the boundaries of its components are held together in a
+/// single immutable, reference-counted allocation so that copying an
+/// owning_uri is no more expensive than copying a pointer. Modifying a
+/// component builds the new text and adjusts the boundaries of the other
+/// components in a single pass.
+///
+/// ~~~cpp
+/// if (auto u = uri::owning_uri::parse ("http://example.com/a?q")) {
+///   u->set_host ("example.org");
+///   std::string_view const s = u->str ();  // "http://example.org/a?q"
+///   ...
+/// }
+/// ~~~
+
+#ifndef URI_OWNING_URI_HPP
+#define URI_OWNING_URI_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+#include "uri/compact_parts.hpp"
+#include "uri/uri.hpp"
+
+namespace uri {
+
+class lazy_parts;
+
+class owning_uri {
+public:
+  /// Constructs an empty relative reference.
+  constexpr owning_uri () noexcept = default;
+  owning_uri (owning_uri const& other) noexcept;
+  constexpr owning_uri (owning_uri&& other) noexcept : rep_{other.rep_} { other.rep_ = nullptr; }
+  ~owning_uri () noexcept;
+
+  owning_uri& operator= (owning_uri const& other) noexcept;
+  owning_uri& operator= (owning_uri&& other) noexcept;
+
+  /// Splits \p in as a URI and, if successful, returns an owning_uri which
+  /// holds a copy of it.
+  static std::optional<owning_uri> parse (std::string_view in);
+  /// Splits \p in as a URI-reference and, if successful, returns an
+  /// owning_uri which holds a copy of it.
+  static std::optional<owning_uri> parse_reference (std::string_view in);
+
+  /// The text of the URI.
+  [[nodiscard]] std::string_view str () const noexcept;
+  /// The boundaries of the components of the URI within str().
+  [[nodiscard]] compact_parts const& bounds () const noexcept;
+
+  [[nodiscard]] std::optional<std::string_view> scheme () const noexcept { return this->view (&compact_parts::scheme); }
+  [[nodiscard]] std::optional<std::string_view> userinfo () const noexcept {
+    return this->view (&compact_parts::userinfo);
+  }
+  [[nodiscard]] std::optional<std::string_view> host () const noexcept { return this->view (&compact_parts::host); }
+  [[nodiscard]] std::optional<std::string_view> port () const noexcept { return this->view (&compact_parts::port); }
+  [[nodiscard]] std::optional<std::string_view> query () const noexcept { return this->view (&compact_parts::query); }
+  [[nodiscard]] std::optional<std::string_view> fragment () const noexcept {
+    return this->view (&compact_parts::fragment);
+  }
+  [[nodiscard]] bool has_authority () const noexcept { return this->bounds ().has_authority (); }
+  /// The text of the path including any leading "/".
+  [[nodiscard]] std::string_view path () const noexcept;
+
+  /// Returns the components of the URI. The strings refer to the text owned by
+  /// this object and the path segments are stored in memory obtained from \p
+  /// resource.
+  [[nodiscard]] parts to_parts (std::pmr::memory_resource* resource = std::pmr::get_default_resource ()) const;
+
+  /// \name Modifiers
+  /// Each of these functions replaces a component. The object is unchanged
+  /// and the function returns false if the new value is not valid or would
+  /// leave the URI invalid.
+  ///@{
+
+  /// Replaces the host. If there is no authority, one is added: this requires
+  /// that the path be empty or begin with "/".
+  bool set_host (std::string_view host);
+  /// Replaces the query or, if \p query is std::nullopt, removes it.
+  bool set_query (std::optional<std::string_view> query);
+  /// Replaces the fragment or, if \p fragment is std::nullopt, removes it.
+  bool set_fragment (std::optional<std::string_view> fragment);
+  ///@}
+
+  friend bool operator== (owning_uri const& lhs, owning_uri const& rhs) noexcept {
+    return lhs.str () == rhs.str ();
+  }
+
+private:
+  struct rep;
+  explicit constexpr owning_uri (rep* const r) noexcept : rep_{r} {}
+
+  [[nodiscard]] std::optional<std::string_view> view (compact_parts::range compact_parts::* const member) const noexcept {
+    return (this->bounds ().*member).view (this->str ());
+  }
+  static std::optional<owning_uri> make (std::string_view in, std::optional<lazy_parts> const& p);
+
+  /// Replaces the characters [first, last) with the concatenation of \p text
+  /// and records \p bounds as the new component boundaries.
+  bool replace (std::size_t first, std::size_t last, std::initializer_list<std::string_view> text,
+                compact_parts const& bounds);
+  /// As replace() but restores the original value if the resulting authority
+  /// is not valid.
+  bool replace_checked (std::size_t first, std::size_t last, std::initializer_list<std::string_view> text,
+                        compact_parts const& bounds);
+  /// Replaces, adds, or removes the query or fragment. If the component is
+  /// not present, it is added at \p pos.
+  bool set_query_or_fragment (compact_parts::range compact_parts::* member, char delimiter, std::size_t pos,
+                              std::optional<std::string_view> value);
+
+  rep* rep_ = nullptr;
+};
+
+}  // end namespace uri
+
+#endif  // URI_OWNING_URI_HPP
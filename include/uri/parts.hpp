@@ -14,7 +14,9 @@
 #define URI_PARTS_HPP
 
 #include <bitset>
+#include <memory_resource>
 
+#include "uri/ascii.hpp"
 #include "uri/icubaby.hpp"
 #include "uri/pctdecode.hpp"
 #include "uri/pctencode.hpp"
@@ -105,6 +107,36 @@ void parts_strings (parts& parts, Function const function) {
   }
 }
 
+/// Writes \p str to \p out applying the syntax-based normalizations of RFC
+/// 3986 section 6.2.2: pct-encoded octets which correspond to unreserved
+/// characters are decoded and the hexadecimal digits of those that remain are
+/// written in upper case. If \p lower is true, the result is also converted
+/// to lower case. The result is never longer than \p str.
+template <std::output_iterator<char> OutputIterator>
+OutputIterator pct_normalize (std::string_view const str, bool const lower, OutputIterator out) {
+  auto const hex_value = [] (char const c) {
+    return ascii::is_digit (c) ? c - '0' : ascii::to_lower (c) - 'a' + 10;
+  };
+  auto const maybe_lower = [lower] (char const c) { return lower ? ascii::to_lower (c) : c; };
+  for (auto pos = std::size_t{0}; pos < str.length (); ++pos) {
+    auto const c = str[pos];
+    if (c != '%' || str.length () - pos < 3 || !ascii::is_hexdig (str[pos + 1]) || !ascii::is_hexdig (str[pos + 2])) {
+      *(out++) = maybe_lower (c);
+      continue;
+    }
+    auto const decoded = static_cast<char> (hex_value (str[pos + 1]) * 16 + hex_value (str[pos + 2]));
+    if (ascii::is_unreserved (decoded)) {
+      *(out++) = maybe_lower (decoded);
+    } else {
+      *(out++) = '%';
+      *(out++) = static_cast<char> (str[pos + 1] - (str[pos + 1] >= 'a' ? 'a' - 'A' : 0));
+      *(out++) = static_cast<char> (str[pos + 2] - (str[pos + 2] >= 'a' ? 'a' - 'A' : 0));
+    }
+    pos += 2;
+  }
+  return out;
+}
+
 template <std::output_iterator<char8_t> OutputIterator>
 struct puny_encoded_result {
   OutputIterator out;
@@ -235,14 +267,21 @@ std::variant<std::error_code, std::size_t> puny_decoded_size (Range&& range) {
 
 }  // end namespace details
 
+/// Returns a copy of \p p in which each component that requires it has been
+/// percent-encoded (or, in the case of the host, punycode-encoded). The
+/// encoded strings are written to \p store; the path segments of the result
+/// use memory from \p resource. Pass a std::pmr::vector<char> as the store to
+/// control where its memory comes from as well.
 template <typename VectorContainer>
   requires std::contiguous_iterator<typename VectorContainer::iterator> &&
            std::is_same_v<typename VectorContainer::value_type, char>
-parts encode (VectorContainer& store, parts const& p) {
+parts encode (VectorContainer& store, parts const& p,
+              std::pmr::memory_resource* const resource = std::pmr::get_default_resource ()) {
   using pft = std::underlying_type_t<parts_field>;
   std::bitset<static_cast<pft> (parts_field::last)> needs_encoding;
 
-  parts result = p;
+  parts result = make_parts (resource);
+  result = p;
   store.clear ();
   auto const convert_to_utf32 = [] (auto const& r) {
     return r | std::views::transform ([] (char const c) { return static_cast<char8_t> (c); }) |
@@ -300,15 +339,19 @@ parts encode (VectorContainer& store, parts const& p) {
   return result;
 }
 
+/// The inverse of encode(). The decoded strings are written to \p store; the
+/// path segments of the result use memory from \p resource.
 template <typename VectorContainer>
   requires std::contiguous_iterator<typename VectorContainer::iterator> &&
            std::is_same_v<typename VectorContainer::value_type, char>
-std::variant<std::error_code, parts> decode (VectorContainer& store,
-                                             parts const& p) {
+std::variant<std::error_code, parts> decode (
+    VectorContainer& store, parts const& p,
+    std::pmr::memory_resource* const resource = std::pmr::get_default_resource ()) {
   using pft = std::underlying_type_t<parts_field>;
   std::bitset<static_cast<pft> (parts_field::last)> needs_encoding;
 
-  parts result = p;
+  parts result = make_parts (resource);
+  result = p;
   store.clear ();
 
   auto required_size = std::size_t{0};
@@ -373,6 +416,88 @@ std::variant<std::error_code, parts> decode (VectorContainer& store,
   return result;
 }
 
+/// Updates each string of \p p which lies within the buffer \p from so that
+/// it refers to the same offset within \p to. Strings which lie outside \p
+/// from are unchanged. Use this when the storage to which \p p refers has
+/// moved: for example, when the store passed to encode() reallocates or the
+/// source string is copied. \p from is used only for its address and need not
+/// still be valid. \p to must be at least as long as \p from.
+void relocate (parts& p, std::string_view from, std::string_view to);
+
+/// Returns a copy of \p p whose strings are copied, one after another, into
+/// \p store. Only the bytes referenced by \p p are copied so that the result
+/// no longer depends on the (possibly much larger) buffer from which it was
+/// split. The path segments of the result use memory from \p resource.
+template <typename VectorContainer>
+  requires std::contiguous_iterator<typename VectorContainer::iterator> &&
+           std::is_same_v<typename VectorContainer::value_type, char>
+parts pack (VectorContainer& store, parts const& p,
+            std::pmr::memory_resource* const resource = std::pmr::get_default_resource ()) {
+  parts result = make_parts (resource);
+  result = p;
+  store.clear ();
+  auto required_size = std::size_t{0};
+  details::parts_strings (result, [&required_size] (std::string_view const str, unsigned, parts_field) {
+    required_size += str.length ();
+    return str;
+  });
+  // Reserving the total size up front means that the store does not
+  // reallocate and the views created below remain valid.
+  store.reserve (required_size);
+  details::parts_strings (result, [&store] (std::string_view const str, unsigned, parts_field) {
+    auto const original_size = store.size ();
+    store.insert (store.end (), str.begin (), str.end ());
+    return std::string_view{store.data () + original_size, str.length ()};
+  });
+  assert (required_size == store.size () && "Expected store required size does not match actual");
+  return result;
+}
+
+/// Returns a copy of \p p normalized as described by RFC 3986 section 6.2.2
+/// (syntax-based normalization):
+///
+/// - the scheme and host are converted to lower case;
+/// - pct-encoded octets which correspond to unreserved characters are decoded
+///   and the hexadecimal digits of the remainder are converted to upper case;
+/// - if there is a scheme or the path is absolute, dot-segments are removed
+///   from the path.
+///
+/// An empty port is also removed as recommended by section 6.2.3. URIs which
+/// are equivalent under these rules yield normalized parts which compare
+/// equal. The normalized strings are written to \p store; the path segments
+/// of the result use memory from \p resource.
+template <typename VectorContainer>
+  requires std::contiguous_iterator<typename VectorContainer::iterator> &&
+           std::is_same_v<typename VectorContainer::value_type, char>
+parts normalize (VectorContainer& store, parts const& p,
+                 std::pmr::memory_resource* const resource = std::pmr::get_default_resource ()) {
+  parts result = make_parts (resource);
+  result = p;
+  store.clear ();
+  // Normalization never lengthens a string so the total of the input lengths
+  // is sufficient.
+  auto required_size = std::size_t{0};
+  details::parts_strings (result, [&required_size] (std::string_view const str, unsigned, parts_field) {
+    required_size += str.length ();
+    return str;
+  });
+  store.reserve (required_size);
+  details::parts_strings (result, [&store] (std::string_view const str, unsigned, parts_field const field) {
+    auto const original_size = store.size ();
+    details::pct_normalize (str, field == parts_field::scheme || field == parts_field::host,
+                            std::back_inserter (store));
+    return std::string_view{store.data () + original_size, store.size () - original_size};
+  });
+  assert (store.size () <= required_size && "Store reallocated");
+  if (result.authority && result.authority->port && result.authority->port->empty ()) {
+    result.authority->port.reset ();
+  }
+  if (result.scheme || result.path.absolute) {
+    result.path.remove_dot_segments ();
+  }
+  return result;
+}
+
 }  // end namespace uri
 
 #endif  // URI_PARTS_HPP
@@ -64,6 +64,18 @@
 /// }
 /// ~~~
 ///
+/// ## Evaluating a Grammar
+///
+/// A grammar is evaluated by constructing a rule from the input string and an
+/// acceptor_log. The log holds the acceptor functions gathered along the
+/// grammar path that matched; they are run, in order, by `done()` once the
+/// complete input has been consumed:
+///
+/// ~~~cpp
+/// acceptor_log log;
+/// bool const ok = rule{input, log}.concat (C).done ();
+/// ~~~
+///
 /// # Gotchas
 ///
 /// There are a couple of gotchas which are important to be aware of:
@@ -79,9 +91,12 @@
 #ifndef URI_RULE_HPP
 #define URI_RULE_HPP
 
-#include <cctype>
-#include <functional>
+#include <array>
+#include <cstddef>
 #include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <optional>
 #include <string_view>
 #include <tuple>
@@ -89,16 +104,129 @@
 #include <utility>
 #include <vector>
 
+#include "uri/ascii.hpp"
+
 namespace uri {
 
+/// The acceptor log records the acceptor functions (and the text that they
+/// matched) that are gathered as the grammar is evaluated. All of the rules
+/// derived from a single root share one log.
+///
+/// A rule remembers only a marker: the number of log entries that were present
+/// when that rule was produced. Appending an entry first discards everything
+/// after the marker so that the entries recorded by failed alternatives are
+/// rolled back without being copied. The consequence is that a rule is only
+/// valid until a rule derived from one of its ancestors appends to the log.
+///
+/// Storage for the first inline_capacity entries is held within the log object
+/// itself so that typical inputs are parsed without touching the heap. Larger
+/// logs obtain memory from the upstream memory resource.
+class acceptor_log {
+public:
+  /// A trivially copyable reference to an acceptor function. Callables which
+  /// fit within a pointer (including function pointers, stateless lambdas, and
+  /// lambdas which capture a single pointer or reference) are stored inline.
+  /// Larger callables are copied to memory owned by the log. A callable which
+  /// is not trivially copyable (such as a lambda which captures a std::string,
+  /// or a std::function) is destroyed when the log is destroyed.
+  class acceptor {
+  public:
+    template <typename Function>
+      requires std::is_invocable_v<Function const&, std::string_view>
+    acceptor (Function&& f, acceptor_log& log) {
+      using function_type = std::remove_cvref_t<Function>;
+      if constexpr (fits_inline<function_type>) {
+        new (storage_.data ()) function_type (std::forward<Function> (f));
+        call_ = [] (void const* const storage, std::string_view const str) {
+          (*std::launder (static_cast<function_type const*> (storage))) (str);
+        };
+      } else {
+        void* const ptr = log.resource_.allocate (sizeof (function_type), alignof (function_type));
+        new (ptr) function_type (std::forward<Function> (f));
+        if constexpr (!std::is_trivially_destructible_v<function_type>) {
+          log.owned_.push_back (
+              {ptr, [] (void* const p) noexcept { std::destroy_at (static_cast<function_type*> (p)); }});
+        }
+        new (storage_.data ()) void const* (ptr);
+        call_ = [] (void const* const storage, std::string_view const str) {
+          (*static_cast<function_type const*> (*std::launder (static_cast<void const* const*> (storage)))) (str);
+        };
+      }
+    }
+
+    void operator() (std::string_view const str) const { call_ (storage_.data (), str); }
+
+  private:
+    /// A callable is stored inline only if it needs no destructor: the inline
+    /// storage is copied and discarded freely.
+    template <typename Function>
+    static constexpr bool fits_inline = sizeof (Function) <= sizeof (void*) && alignof (Function) <= alignof (void*) &&
+                                        std::is_trivially_copyable_v<Function>;
+
+    void (*call_) (void const*, std::string_view) = nullptr;
+    alignas (void*) std::array<std::byte, sizeof (void*)> storage_{};
+  };
+  struct value_type {
+    acceptor accept;
+    std::string_view str;
+  };
+  using marker = std::size_t;
+
+  static constexpr std::size_t inline_capacity = 64;
+
+  explicit acceptor_log (std::pmr::memory_resource* const upstream = std::pmr::get_default_resource ())
+      : resource_{buffer_.data (), buffer_.size (), upstream}, entries_{&resource_}, owned_{&resource_} {
+    entries_.reserve (inline_capacity);
+  }
+  acceptor_log (acceptor_log const&) = delete;
+  acceptor_log (acceptor_log&&) noexcept = delete;
+  ~acceptor_log () noexcept {
+    for (auto const& [ptr, destroy] : owned_) {
+      destroy (ptr);
+    }
+  }
+
+  acceptor_log& operator= (acceptor_log const&) = delete;
+  acceptor_log& operator= (acceptor_log&&) noexcept = delete;
+
+  /// Discards any entries after \p pos and then records \p accept and \p str.
+  ///
+  /// \returns  The marker for the log after the new entry has been appended.
+  template <typename AcceptFunction>
+  marker append (marker const pos, AcceptFunction&& accept, std::string_view const str) {
+    this->rollback (pos);
+    entries_.push_back ({acceptor{std::forward<AcceptFunction> (accept), *this}, str});
+    return entries_.size ();
+  }
+  /// Discards the entries that were recorded after \p pos.
+  void rollback (marker const pos) {
+    if (pos < entries_.size ()) {
+      entries_.erase (entries_.begin () + static_cast<std::ptrdiff_t> (pos), entries_.end ());
+    }
+  }
+  /// Invokes the acceptor functions recorded before \p last in the order in
+  /// which they were appended.
+  void run (marker last) const;
+
+  [[nodiscard]] std::size_t size () const noexcept { return entries_.size (); }
+
+private:
+  alignas (value_type) std::array<std::byte, inline_capacity * sizeof (value_type)> buffer_;
+  std::pmr::monotonic_buffer_resource resource_;
+  std::pmr::vector<value_type> entries_;
+  /// The acceptors held in resource_ whose destructors must be run.
+  struct owned_callable {
+    void* ptr;
+    void (*destroy) (void*) noexcept;
+  };
+  std::pmr::vector<owned_callable> owned_;
+};
+
 class rule {
 public:
-  using acceptor_container = std::vector<
-    std::tuple<std::function<void (std::string_view)>, std::string_view>>;
-  using matched_result =
-    std::optional<std::tuple<std::string_view, acceptor_container>>;
+  using matched_result = std::optional<std::tuple<std::string_view, acceptor_log::marker>>;
 
-  explicit rule (std::string_view string) : tail_{string} {}
+  rule (std::string_view string, acceptor_log& log) : tail_{string}, log_{&log} {}
   rule (rule const& rhs) = default;
   rule (rule&& rhs) noexcept = default;
   ~rule () noexcept = default;
@@ -161,36 +289,25 @@ public:
   template <typename Predicate>
   [[nodiscard]] matched_result single_char (Predicate pred) const;
   [[nodiscard]] matched_result single_char (char const c) const {
-    return single_char ([c2 = std::tolower (static_cast<int> (c))] (char d) {
-      return c2 == std::tolower (static_cast<int> (d));
-    });
+    return single_char ([c2 = ascii::to_lower (c)] (char const d) { return c2 == ascii::to_lower (d); });
   }
 
 private:
-  rule (std::optional<std::string_view> tail, acceptor_container acceptors)
-      : tail_{tail}, acceptors_{std::move (acceptors)} {}
+  constexpr rule (std::optional<std::string_view> tail, acceptor_log* const log, acceptor_log::marker const pos) noexcept
+      : tail_{tail}, log_{log}, pos_{pos} {}
   rule () noexcept = default;
 
   template <typename MatchFunction, typename AcceptFunction>
   rule concat_impl (MatchFunction match, AcceptFunction accept,
                     bool optional) const;
 
-  static acceptor_container join (acceptor_container const& a,
-                                  acceptor_container const& b) {
-    acceptor_container result;
-    result.reserve (a.size () + b.size ());
-    result.insert (result.end (), a.begin (), a.end ());
-    result.insert (result.end (), b.begin (), b.end ());
-    return result;
-  }
+  /// Returns a rule which starts matching at \p tail with the log position of
+  /// this rule.
+  [[nodiscard]] constexpr rule child (std::string_view const tail) const noexcept { return {tail, log_, pos_}; }
 
   [[nodiscard]] rule join_rule (matched_result::value_type const& m) const {
-    auto const& [head, acc] = m;
-    return {tail_->substr (head.length ()), join (acceptors_, acc)};
-  }
-
-  [[nodiscard]] rule join_rule (rule const& other) const {
-    return {other.tail_, join (acceptors_, other.acceptors_)};
+    auto const& [head, pos] = m;
+    return {tail_->substr (head.length ()), log_, pos};
   }
 
   static void accept_nop (std::string_view str) {
@@ -201,7 +318,8 @@ private:
   constexpr bool is_nop (Function f) const noexcept;
 
   std::optional<std::string_view> tail_;
-  acceptor_container acceptors_;
+  acceptor_log* log_ = nullptr;
+  acceptor_log::marker pos_ = 0;
 };
 
 // star
@@ -214,10 +332,10 @@ rule rule::star (MatchFunction const match, unsigned const min, unsigned const m
   }
   auto length = std::string_view::size_type{0};
   std::string_view str = *tail_;
-  auto acc = acceptors_;
+  auto pos = pos_;
   auto count = 0U;
   for (;;) {
-    matched_result const m = match (rule{str});
+    matched_result const m = match (rule{str, log_, pos});
     if (!m) {
       break;  // No match so no more repetitions.
     }
@@ -230,14 +348,13 @@ rule rule::star (MatchFunction const match, unsigned const min, unsigned const m
     str.remove_prefix (l);
     length += l;
     // Remember the corresponding acceptor functions.
-    auto const& a = std::get<acceptor_container> (*m);
-    acc.insert (acc.end (), a.begin (), a.end ());
+    pos = std::get<acceptor_log::marker> (*m);
   }
   if (count < min) {
     return {};
   }
 
-  return {tail_->substr (length), std::move (acc)};
+  return {tail_->substr (length), log_, pos};
 }
 
 // alternative
@@ -249,7 +366,7 @@ rule rule::alternative (MatchFunction match, Rest&&... rest) const {
     // If matching has already failed, then pass that condition down the chain.
     return *this;
   }
-  if (matched_result const m = match (rule{*tail_})) {
+  if (matched_result const m = match (this->child (*tail_))) {
     return join_rule (*m);
   }
   // This didn't match, so try the next one.
@@ -273,14 +390,9 @@ constexpr bool rule::is_nop (Function f) const noexcept {
 template <typename MatchFunction, typename AcceptFunction>
   requires std::is_invocable_v<MatchFunction, rule&&> && std::is_invocable_v<AcceptFunction, std::string_view>
 rule rule::optional (MatchFunction match, AcceptFunction accept) const {
-  if (!tail_) {
-    return *this;  // If matching previously failed, yield failure.
-  }
-  rule res = rule{*tail_}.concat_impl (match, accept, true);
-  if (!res.tail_) {
-    return *this;  // The rule failed, so carry on as if nothing happened.
-  }
-  return join_rule (res);
+  // If matching previously failed, yield failure. If the rule fails, carry
+  // on as if nothing happened.
+  return this->concat_impl (match, accept, true);
 }
 
 template <typename MatchFunction>
@@ -298,10 +410,10 @@ rule rule::concat_impl (MatchFunction match, AcceptFunction accept,
     // If matching has already failed, then pass that condition down the chain.
     return *this;
   }
-  if (matched_result m = match (rule{*tail_})) {
+  if (matched_result const m = match (this->child (*tail_))) {
+    auto const& [head, pos] = *m;
     if (!is_nop (accept)) {
-      std::get<acceptor_container> (*m).emplace_back (
-        accept, std::get<std::string_view> (*m));
+      return {tail_->substr (head.length ()), log_, log_->append (pos, accept, head)};
     }
     return join_rule (*m);
   }
@@ -317,7 +429,7 @@ template <typename Predicate>
 auto rule::single_char (Predicate const pred) const -> matched_result {
   if (auto const sv = this->tail ();
       sv && !sv->empty () && pred (sv->front ())) {
-    return std::make_tuple (sv->substr (0, 1), acceptor_container{});
+    return std::make_tuple (sv->substr (0, 1), pos_);
   }
   return {};
 }
@@ -326,26 +438,22 @@ inline auto single_char (char const first) {
   return [=] (rule const& r) { return r.single_char (first); };
 }
 inline auto char_range (char const first, char const last) {
-  return [f = std::tolower (static_cast<int> (first)),
-          l = std::tolower (static_cast<int> (last))] (rule const& r) {
+  return [f = ascii::to_lower (first), l = ascii::to_lower (last)] (rule const& r) {
     return r.single_char ([=] (char const c) {
-      auto const cl = std::tolower (static_cast<int> (c));
+      auto const cl = ascii::to_lower (c);
       return cl >= f && cl <= l;
     });
   };
 }
 
 inline auto alpha (rule const& r) {
-  return r.single_char (
-    [] (char const c) { return std::isalpha (static_cast<int> (c)); });
+  return r.single_char (ascii::is_alpha);
 }
 inline auto digit (rule const& r) {
-  return r.single_char (
-    [] (char const c) { return std::isdigit (static_cast<int> (c)); });
+  return r.single_char (ascii::is_digit);
 }
 inline auto hexdig (rule const& r) {
-  return r.single_char (
-    [] (char const c) { return std::isxdigit (static_cast<int> (c)); });
+  return r.single_char (ascii::is_hexdig);
 }
 
 }  // end namespace uri
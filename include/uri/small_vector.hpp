@@ -0,0 +1,277 @@
+//===- include/uri/small_vector.hpp -----------------------*- mode: C++ -*-===//
+//*                      _ _                  _              *
+//*  ___ _ __ ___   __ _| | | __   _____  ___| |_ ___  _ __  *
+//* / __| '_ ` _ \ / _` | | | \ \ / / _ \/ __| __/ _ \| '__| *
+//* \__ \ | | | | | (_| | | |  \ V /  __/ (__| || (_) | |    *
+//* |___/_| |_| |_|\__,_|_|_|   \_/ \___|\___|\__\___/|_|    *
+//*                                                          *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file small_vector.hpp
+/// \brief A vector-like container with inline storage for a small number of
+///   elements.
+
+#ifndef URI_SMALL_VECTOR_HPP
+#define URI_SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace uri {
+
+/// A sequence container which stores up to \p N elements within the object
+/// itself and obtains storage from \p Allocator only if that capacity is
+/// exceeded. The interface is a subset of that of std::vector<>; in particular,
+/// the allocator is propagated (or not) on copy, move, and assignment in the
+/// same way.
+///
+/// The element type must be trivially copyable so that elements can be
+/// relocated without running constructors or destructors.
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+  requires std::is_trivially_copyable_v<T> && (N > 0)
+class small_vector {
+  using traits = std::allocator_traits<Allocator>;
+
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using pointer = value_type*;
+  using const_pointer = value_type const*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type inline_capacity = N;
+
+  small_vector () noexcept (noexcept (Allocator ())) = default;
+  explicit small_vector (Allocator const& alloc) noexcept : alloc_{alloc} {}
+  small_vector (std::initializer_list<T> const init, Allocator const& alloc = Allocator ()) : alloc_{alloc} {
+    this->assign (init.begin (), init.end ());
+  }
+  template <std::input_iterator InputIterator>
+  small_vector (InputIterator first, InputIterator last, Allocator const& alloc = Allocator ()) : alloc_{alloc} {
+    this->assign (first, last);
+  }
+  small_vector (small_vector const& rhs) : alloc_{traits::select_on_container_copy_construction (rhs.alloc_)} {
+    this->assign (rhs.begin (), rhs.end ());
+  }
+  small_vector (small_vector const& rhs, Allocator const& alloc) : alloc_{alloc} {
+    this->assign (rhs.begin (), rhs.end ());
+  }
+  small_vector (small_vector&& rhs) noexcept : alloc_{std::move (rhs.alloc_)} { this->move_from (rhs); }
+  ~small_vector () noexcept { this->deallocate (); }
+
+  small_vector& operator= (small_vector const& rhs) {
+    if (&rhs != this) {
+      if constexpr (traits::propagate_on_container_copy_assignment::value) {
+        if (alloc_ != rhs.alloc_) {
+          this->release ();
+        }
+        alloc_ = rhs.alloc_;
+      }
+      this->assign (rhs.begin (), rhs.end ());
+    }
+    return *this;
+  }
+  small_vector& operator= (small_vector&& rhs) noexcept (traits::propagate_on_container_move_assignment::value ||
+                                                         traits::is_always_equal::value) {
+    if (&rhs != this) {
+      if constexpr (traits::propagate_on_container_move_assignment::value) {
+        this->release ();
+        alloc_ = std::move (rhs.alloc_);
+      } else if (alloc_ != rhs.alloc_) {
+        // The storage belongs to a different allocator: copy the elements.
+        this->assign (rhs.begin (), rhs.end ());
+        rhs.clear ();
+        return *this;
+      } else {
+        this->release ();
+      }
+      this->move_from (rhs);
+    }
+    return *this;
+  }
+  small_vector& operator= (std::initializer_list<T> const init) {
+    this->assign (init.begin (), init.end ());
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator () const noexcept { return alloc_; }
+
+  // element access
+  [[nodiscard]] reference operator[] (size_type const pos) noexcept {
+    assert (pos < size_);
+    return data_[pos];
+  }
+  [[nodiscard]] const_reference operator[] (size_type const pos) const noexcept {
+    assert (pos < size_);
+    return data_[pos];
+  }
+  [[nodiscard]] reference front () noexcept { return (*this)[0]; }
+  [[nodiscard]] const_reference front () const noexcept { return (*this)[0]; }
+  [[nodiscard]] reference back () noexcept { return (*this)[size_ - 1U]; }
+  [[nodiscard]] const_reference back () const noexcept { return (*this)[size_ - 1U]; }
+  [[nodiscard]] pointer data () noexcept { return data_; }
+  [[nodiscard]] const_pointer data () const noexcept { return data_; }
+
+  // iterators
+  [[nodiscard]] iterator begin () noexcept { return data_; }
+  [[nodiscard]] const_iterator begin () const noexcept { return data_; }
+  [[nodiscard]] const_iterator cbegin () const noexcept { return data_; }
+  [[nodiscard]] iterator end () noexcept { return data_ + size_; }
+  [[nodiscard]] const_iterator end () const noexcept { return data_ + size_; }
+  [[nodiscard]] const_iterator cend () const noexcept { return data_ + size_; }
+  [[nodiscard]] reverse_iterator rbegin () noexcept { return reverse_iterator{this->end ()}; }
+  [[nodiscard]] const_reverse_iterator rbegin () const noexcept { return const_reverse_iterator{this->end ()}; }
+  [[nodiscard]] reverse_iterator rend () noexcept { return reverse_iterator{this->begin ()}; }
+  [[nodiscard]] const_reverse_iterator rend () const noexcept { return const_reverse_iterator{this->begin ()}; }
+
+  // capacity
+  [[nodiscard]] bool empty () const noexcept { return size_ == 0; }
+  [[nodiscard]] size_type size () const noexcept { return size_; }
+  [[nodiscard]] size_type capacity () const noexcept { return capacity_; }
+  [[nodiscard]] static constexpr size_type max_size () noexcept {
+    return std::numeric_limits<std::uint32_t>::max ();
+  }
+  /// Returns true if the elements are held within the object rather than on
+  /// the heap.
+  [[nodiscard]] bool is_inline () const noexcept { return data_ == this->inline_data (); }
+  /// Throws std::length_error if \p new_cap is greater than max_size(). resize()
+  /// grows the vector through reserve() and so does the same.
+  void reserve (size_type const new_cap) {
+    if (new_cap > max_size ()) {
+      throw std::length_error{"small_vector"};
+    }
+    if (new_cap > capacity_) {
+      this->reallocate (new_cap);
+    }
+  }
+
+  // modifiers
+  void clear () noexcept { size_ = 0; }
+  template <typename... Args>
+  reference emplace_back (Args&&... args) {
+    // Construct the new value before the storage can be reallocated in case
+    // the arguments refer to an existing element.
+    T value (std::forward<Args> (args)...);
+    if (size_ == capacity_) {
+      this->reallocate (this->grown_capacity (size_ + 1U));
+    }
+    return *std::construct_at (data_ + size_++, value);
+  }
+  void push_back (T const& value) { this->emplace_back (value); }
+  void push_back (T&& value) { this->emplace_back (std::move (value)); }
+  void pop_back () noexcept {
+    assert (size_ > 0);
+    --size_;
+  }
+  void resize (size_type const count) { this->resize (count, T{}); }
+  void resize (size_type const count, T const& value) {
+    if (count > size_) {
+      T const v = value;
+      this->reserve (count);
+      std::uninitialized_fill (data_ + size_, data_ + count, v);
+    }
+    size_ = static_cast<std::uint32_t> (count);
+  }
+  iterator erase (const_iterator const pos) { return this->erase (pos, pos + 1); }
+  iterator erase (const_iterator const first, const_iterator const last) {
+    assert (first >= this->begin () && first <= last && last <= this->end ());
+    auto const f = data_ + (first - data_);
+    auto const new_end = std::copy (data_ + (last - data_), this->end (), f);
+    size_ = static_cast<std::uint32_t> (new_end - data_);
+    return f;
+  }
+  template <std::input_iterator InputIterator>
+  void assign (InputIterator first, InputIterator last) {
+    this->clear ();
+    if constexpr (std::forward_iterator<InputIterator>) {
+      this->reserve (static_cast<size_type> (std::distance (first, last)));
+    }
+    for (; first != last; ++first) {
+      this->emplace_back (*first);
+    }
+  }
+
+  friend bool operator== (small_vector const& lhs, small_vector const& rhs) {
+    return std::equal (lhs.begin (), lhs.end (), rhs.begin (), rhs.end ());
+  }
+
+private:
+  [[nodiscard]] T* inline_data () noexcept { return reinterpret_cast<T*> (buffer_.data ()); }
+  [[nodiscard]] T const* inline_data () const noexcept { return reinterpret_cast<T const*> (buffer_.data ()); }
+
+  [[nodiscard]] size_type grown_capacity (size_type const required) const {
+    if (required > max_size ()) {
+      throw std::length_error{"small_vector"};
+    }
+    return std::min (std::max (required, size_type{capacity_} * 2U), max_size ());
+  }
+
+  /// Moves the elements to a buffer with room for \p new_cap elements obtained
+  /// from the allocator.
+  void reallocate (size_type const new_cap) {
+    assert (new_cap > capacity_);
+    T* const p = std::to_address (traits::allocate (alloc_, new_cap));
+    std::uninitialized_copy (this->begin (), this->end (), p);
+    this->deallocate ();
+    data_ = p;
+    capacity_ = static_cast<std::uint32_t> (new_cap);
+  }
+  void deallocate () noexcept {
+    if (!this->is_inline ()) {
+      traits::deallocate (alloc_, data_, capacity_);
+    }
+  }
+  /// Releases any allocated storage leaving the container empty.
+  void release () noexcept {
+    this->deallocate ();
+    data_ = this->inline_data ();
+    size_ = 0;
+    capacity_ = N;
+  }
+  /// Takes the contents of \p rhs. A heap buffer is stolen; inline elements
+  /// are copied. \p rhs is left empty.
+  void move_from (small_vector& rhs) noexcept {
+    if (rhs.is_inline ()) {
+      data_ = this->inline_data ();
+      capacity_ = N;
+      std::uninitialized_copy (rhs.begin (), rhs.end (), data_);
+    } else {
+      data_ = rhs.data_;
+      capacity_ = rhs.capacity_;
+      rhs.data_ = rhs.inline_data ();
+      rhs.capacity_ = N;
+    }
+    size_ = rhs.size_;
+    rhs.size_ = 0;
+  }
+
+  [[no_unique_address]] Allocator alloc_{};
+  T* data_ = this->inline_data ();
+  std::uint32_t size_ = 0;
+  std::uint32_t capacity_ = N;
+  alignas (T) std::array<std::byte, N * sizeof (T)> buffer_;
+};
+
+}  // end namespace uri
+
+#endif  // URI_SMALL_VECTOR_HPP
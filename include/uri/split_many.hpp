@@ -0,0 +1,110 @@
+//===- include/uri/split_many.hpp -------------------------*- mode: C++ -*-===//
+//*            _ _ _                                  *
+//*  ___ _ __ | (_) |_   _ __ ___   __ _ _ __  _   _  *
+//* / __| '_ \| | | __| | '_ ` _ \ / _` | '_ \| | | | *
+//* \__ \ |_) | | | |_  | | | | | | (_| | | | | |_| | *
+//* |___/ .__/|_|_|\__| |_| |_| |_|\__,_|_| |_|\__, | *
+//*     |_|                                    |___/  *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file split_many.hpp
+/// \brief Splits a batch of URIs into columns.
+///
+/// split_many() and split_reference_many() split each of a sequence of inputs
+/// exactly as split() and split_reference() would. Rather than producing a
+/// parts object per input, the components are written to columns: one array
+/// per component, each holding a compact_parts::range for every input. Callers
+/// that are interested in only one or two components can scan just those
+/// arrays.
+
+#ifndef URI_SPLIT_MANY_HPP
+#define URI_SPLIT_MANY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "uri/compact_parts.hpp"
+#include "uri/uri.hpp"
+
+namespace uri {
+
+/// The results of splitting a batch of inputs. Row i of each column describes
+/// input i; its ranges are offsets within that input.
+class split_columns {
+public:
+  using range = compact_parts::range;
+  using column = std::pmr::vector<range>;
+  using bitmap = std::pmr::vector<std::uint64_t>;
+
+  explicit split_columns (std::pmr::memory_resource* const resource = std::pmr::get_default_resource ())
+      : scheme{resource},
+        userinfo{resource},
+        host{resource},
+        port{resource},
+        path{resource},
+        query{resource},
+        fragment{resource},
+        valid_bits{resource},
+        absolute_bits{resource} {}
+
+  /// \name Columns
+  /// These hold the corresponding members of the compact_parts of each
+  /// input. The ranges of an invalid input are all absent.
+  ///@{
+  column scheme;
+  column userinfo;
+  column host;  ///< Present if and only if the input has an authority.
+  column port;
+  column path;
+  column query;
+  column fragment;
+  ///@}
+
+  /// Bit (i % 64) of valid_bits[i / 64] is set if input i was successfully
+  /// split.
+  bitmap valid_bits;
+  /// Bit (i % 64) of absolute_bits[i / 64] is set if the path of input i is
+  /// absolute.
+  bitmap absolute_bits;
+
+  [[nodiscard]] std::size_t size () const noexcept { return scheme.size (); }
+  [[nodiscard]] bool empty () const noexcept { return scheme.empty (); }
+  [[nodiscard]] bool valid (std::size_t const row) const noexcept { return test (valid_bits, row); }
+  [[nodiscard]] bool absolute (std::size_t const row) const noexcept { return test (absolute_bits, row); }
+
+  /// Returns the compact representation of row \p row.
+  [[nodiscard]] compact_parts compact_row (std::size_t row) const noexcept;
+  /// Returns the parts of row \p row whose source is \p source or std::nullopt
+  /// if the input could not be split. The result is equal to that of calling
+  /// split() (or split_reference()) with the same input.
+  [[nodiscard]] std::optional<parts> row (std::size_t row, std::string_view source) const;
+
+  void clear () noexcept;
+  void reserve (std::size_t rows);
+  /// Appends a row. If \p c is std::nullopt the row is marked as invalid.
+  void push_back (std::optional<compact_parts> const& c);
+
+private:
+  static bool test (bitmap const& bits, std::size_t const row) noexcept {
+    return (bits[row / 64U] >> (row % 64U)) & 1U;
+  }
+};
+
+/// Splits each of \p inputs as a URI (split_many) or URI-reference
+/// (split_reference_many) replacing the contents of \p out. Row i of \p out
+/// matches the result of split(inputs[i]) or split_reference(inputs[i]).
+/// Inputs of 4GiB or more cannot be represented and are marked invalid.
+void split_many (std::span<std::string_view const> inputs, split_columns& out);
+void split_reference_many (std::span<std::string_view const> inputs, split_columns& out);
+
+}  // end namespace uri
+
+#endif  // URI_SPLIT_MANY_HPP
@@ -0,0 +1,55 @@
+//===- include/uri/split_options.hpp ----------------------*- mode: C++ -*-===//
+//*            _ _ _                 _   _                  *
+//*  ___ _ __ | (_) |_    ___  _ __ | |_(_) ___  _ __  ___  *
+//* / __| '_ \| | | __|  / _ \| '_ \| __| |/ _ \| '_ \/ __| *
+//* \__ \ |_) | | | |_  | (_) | |_) | |_| | (_) | | | \__ \ *
+//* |___/ .__/|_|_|\__|  \___/| .__/ \__|_|\___/|_| |_|___/ *
+//*     |_|                   |_|                           *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file split_options.hpp
+/// \brief Options which control the work done when splitting a URI.
+///
+/// These types are needed by callers of uri.hpp. They live apart from the
+/// grammar so that including uri.hpp does not also include the grammar
+/// templates, which are private to the library.
+
+#ifndef URI_SPLIT_OPTIONS_HPP
+#define URI_SPLIT_OPTIONS_HPP
+
+#include <cstddef>
+#include <limits>
+
+namespace uri {
+
+namespace grammar {
+
+/// Controls whether a context records the results of productions wrapped in
+/// memo<> so that each is evaluated at most once for each input position.
+enum class memoization : bool { off, on };
+
+}  // end namespace grammar
+
+/// Bounds the work done by split() and split_reference() for inputs that
+/// require backtracking. No more than base + per_byte * (input length)
+/// characters may be scanned a second time. With the defaults, the time taken
+/// to split any input is linear in its length.
+struct split_budget {
+  std::size_t base = 256;
+  std::size_t per_byte = 8;
+
+  [[nodiscard]] constexpr std::size_t limit (std::size_t const length) const noexcept {
+    constexpr auto max = std::numeric_limits<std::size_t>::max ();
+    if (per_byte != 0 && length > (max - base) / per_byte) {
+      return max;
+    }
+    return base + per_byte * length;
+  }
+};
+
+}  // end namespace uri
+
+#endif  // URI_SPLIT_OPTIONS_HPP
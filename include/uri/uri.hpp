@@ -13,12 +13,22 @@
 #ifndef URI_URI_HPP
 #define URI_URI_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <iosfwd>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
-#include <vector>
+#include <system_error>
+#include <variant>
+
+#include "uri/small_vector.hpp"
+#include "uri/split_options.hpp"
 
 namespace uri {
 
@@ -71,10 +81,18 @@ enum class code_point : unsigned {
 
 struct parts {
   struct path {
+    /// The number of segments that can be stored without a heap allocation.
+    static constexpr std::size_t inline_segments = 8;
+    using segments_type =
+        small_vector<std::string_view, inline_segments, std::pmr::polymorphic_allocator<std::string_view>>;
+
     bool absolute = false;
-    std::vector<std::string_view> segments;
+    /// Segments beyond the first inline_segments are stored in memory obtained
+    /// from the container's memory resource.
+    segments_type segments;
 
-    // Remove dot segments from the path.
+    // Remove dot segments from the path. A path without dot segments is
+    // recognized with a single pass and left untouched.
     void remove_dot_segments ();
     [[nodiscard]] bool empty () const noexcept { return segments.empty (); }
     [[nodiscard]] bool valid () const noexcept;
@@ -111,21 +129,291 @@ struct parts {
   bool operator!= (parts const& rhs) const { return !operator== (rhs); }
 };
 
+/// Returns an empty parts object whose path segments will be stored in memory
+/// obtained from \p resource.
+inline parts make_parts (std::pmr::memory_resource* const resource) {
+  return parts{std::nullopt, std::nullopt, {false, parts::path::segments_type{resource}}, std::nullopt, std::nullopt};
+}
+
 std::ostream& operator<< (std::ostream& os, struct parts::path const& path);
 std::ostream& operator<< (std::ostream& os,
                           struct parts::authority const& auth);
 std::ostream& operator<< (std::ostream& os, parts const& p);
 
-std::optional<parts> split (std::string_view in);
-std::optional<parts> split_reference (std::string_view in);
+/// Splits \p in as a URI (or, in the case of split_reference(), a
+/// URI-reference). Any memory needed, including that for the path segments of
+/// the result, is obtained from \p resource.
+std::optional<parts> split (std::string_view in,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+std::optional<parts> split_reference (std::string_view in,
+                                      std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+
+enum class split_error : int {
+  none,
+  bad_syntax,
+  budget_exhausted,
+};
+
+class split_error_category final : public std::error_category {
+public:
+  char const* name () const noexcept override;
+  std::string message (int error) const override;
+};
+std::error_code make_error_code (split_error e);
+
+/// Splits \p in as a URI (or, in the case of split_reference(), a
+/// URI-reference) while limiting the work done to \p budget. Input which does
+/// not match the grammar yields split_error::bad_syntax. Input which exceeds
+/// the budget yields split_error::budget_exhausted. Memory is obtained from
+/// \p resource.
+std::variant<std::error_code, parts> split (std::string_view in, split_budget const& budget,
+                                            std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+std::variant<std::error_code, parts> split_reference (
+    std::string_view in, split_budget const& budget,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+
+namespace details {
+
+/// Returns true if the characters of \p inner lie entirely within \p outer.
+/// The two need not refer to the same object.
+bool within (std::string_view outer, std::string_view inner) noexcept;
+
+enum class scan_result { success, failure, fallback };
+
+/// A single-pass recognizer for the URI production or, if \p reference is
+/// true, URI-reference. Results are identical to those of the grammar except
+/// that inputs whose authority contains an IP-literal yield
+/// scan_result::fallback.
+scan_result scan (std::string_view in, bool reference, parts& result);
+/// Recognizes the authority production. \p auth is the text between "//" and
+/// the next "/", "?", "#" or the end of the input. Authorities which contain an
+/// IP-literal yield scan_result::fallback.
+scan_result scan_authority (std::string_view auth, struct parts::authority& result);
+/// Recognizes the authority production as scan_authority() does but uses the
+/// grammar for an authority which contains an IP-literal. Returns false if \p
+/// auth is not a valid authority.
+bool valid_authority (std::string_view auth, struct parts::authority& result);
+/// Sets the userinfo, host and port of \p result to the parts of \p auth, the
+/// text of an authority, which they occupy. \p auth is not validated.
+void delimit_authority (std::string_view auth, struct parts::authority& result) noexcept;
+/// Returns true if \p path, the text of a path excluding any leading "/", is a
+/// sequence of valid segments. If \p no_colon is true, the first segment must
+/// not contain a colon (path-noscheme).
+bool valid_path (std::string_view path, bool no_colon) noexcept;
+/// Appends the segments of \p path, the text of a path excluding any leading
+/// "/", to \p segments. \p path is not validated.
+void split_segments (std::string_view path, parts::path::segments_type& segments);
+
+/// The grammar-based implementations of split() and split_reference(). They
+/// are used where scan() cannot handle the input.
+std::optional<parts> split_rules (std::string_view in, grammar::memoization memo = grammar::memoization::off);
+std::optional<parts> split_reference_rules (std::string_view in,
+                                            grammar::memoization memo = grammar::memoization::off);
+
+}  // end namespace details
+
+/// A set of URI components. The bit for each component is 1 << parts_field.
+enum class field_mask : std::uint8_t {
+  none = 0,
+  scheme = 1U << 0U,
+  userinfo = 1U << 1U,
+  host = 1U << 2U,
+  port = 1U << 3U,
+  query = 1U << 4U,
+  fragment = 1U << 5U,
+  path = 1U << 6U,
+  authority = userinfo | host | port,
+  all = scheme | authority | query | fragment | path,
+};
+constexpr field_mask operator| (field_mask const lhs, field_mask const rhs) noexcept {
+  return static_cast<field_mask> (static_cast<unsigned> (lhs) | static_cast<unsigned> (rhs));
+}
+constexpr field_mask operator& (field_mask const lhs, field_mask const rhs) noexcept {
+  return static_cast<field_mask> (static_cast<unsigned> (lhs) & static_cast<unsigned> (rhs));
+}
+/// Returns true if \p mask includes any of the components in \p fields.
+constexpr bool includes (field_mask const mask, field_mask const fields) noexcept {
+  return (mask & fields) != field_mask::none;
+}
+
+namespace details {
+
+/// Like scan() but records only the components in \p fields and stops as
+/// soon as they are known. Components which are not recorded are not
+/// validated. Never yields scan_result::fallback: an authority which contains
+/// an IP-literal is checked using the grammar.
+scan_result scan_fields (std::string_view in, bool reference, field_mask fields, parts& result);
+std::optional<parts> split_fields (std::string_view in, bool reference, field_mask fields, bool strict,
+                                   std::pmr::memory_resource* resource);
+
+}  // end namespace details
+
+/// Splits \p in as a URI (or, in the case of split_reference(), a
+/// URI-reference) but records only the components in \p Fields. The
+/// remainder of the result is empty: absent optionals, an empty host, and no
+/// path segments.
+///
+/// Scanning stops once the requested components are known so that, for
+/// example, extracting the scheme and host does not examine the path or query.
+/// The components that are not requested are validated only if \p strict is
+/// true, in which case the result is std::nullopt whenever split() would fail.
+/// Otherwise, std::nullopt indicates that a requested component is invalid or
+/// that the input does not have the structure of a URI.
+///
+/// ~~~cpp
+/// constexpr auto fields = uri::field_mask::scheme | uri::field_mask::host;
+/// if (auto const p = uri::split<fields> ("http://example.com/a/b?q")) {
+///   ... // p->scheme == "http", p->authority->host == "example.com"
+/// }
+/// ~~~
+template <field_mask Fields>
+std::optional<parts> split (std::string_view const in, bool const strict = false,
+                            std::pmr::memory_resource* const resource = std::pmr::get_default_resource ()) {
+  return details::split_fields (in, false, Fields, strict, resource);
+}
+template <field_mask Fields>
+std::optional<parts> split_reference (std::string_view const in, bool const strict = false,
+                                      std::pmr::memory_resource* const resource = std::pmr::get_default_resource ()) {
+  return details::split_fields (in, true, Fields, strict, resource);
+}
+
+/// Resolves \p reference against \p base. The path segments of the result are
+/// stored in memory obtained from \p resource.
+parts join (parts const& base, parts const& reference, bool strict = true,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
+std::optional<parts> join (std::string_view Base, std::string_view R, bool strict = true,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource ());
 
-parts join (parts const& base, parts const& reference, bool strict = true);
-std::optional<parts> join (std::string_view Base, std::string_view R,
-                           bool strict = true);
+namespace details {
 
+template <std::output_iterator<char> OutputIterator>
+OutputIterator compose_string (std::string_view const str, OutputIterator out) {
+  return std::copy (str.begin (), str.end (), out);
+}
+
+/// Writes \p path to \p out. An absolute path begins with "/" unless it has
+/// no segments.
+template <std::output_iterator<char> OutputIterator>
+OutputIterator compose_path (struct parts::path const& path, OutputIterator out) {
+  auto first = !path.absolute;
+  for (auto const& seg : path.segments) {
+    if (!first) {
+      *(out++) = '/';
+    }
+    out = compose_string (seg, out);
+    first = false;
+  }
+  return out;
+}
+
+/// Writes the userinfo, host and port of \p auth which are selected by
+/// \p fields to \p out. The leading "//" is not written.
+template <std::output_iterator<char> OutputIterator>
+OutputIterator compose_authority (struct parts::authority const& auth, field_mask const fields, OutputIterator out) {
+  if (auth.userinfo.has_value () && includes (fields, field_mask::userinfo)) {
+    out = compose_string (*auth.userinfo, out);
+    *(out++) = '@';
+  }
+  if (includes (fields, field_mask::host)) {
+    out = compose_string (auth.host, out);
+  }
+  if (auth.port.has_value () && includes (fields, field_mask::port)) {
+    *(out++) = ':';
+    out = compose_string (*auth.port, out);
+  }
+  return out;
+}
+
+}  // end namespace details
+
+/// Returns the number of characters written by compose(p).
+std::size_t composed_size (parts const& p) noexcept;
+
+/// Writes the components of \p p selected by \p fields to \p out, each with
+/// its delimiters. Returns the iterator that follows the last character
+/// written. Nothing is allocated.
+///
+/// For example, field_mask::scheme | field_mask::host | field_mask::port
+/// writes the origin ("https://example.com:8080") and field_mask::path |
+/// field_mask::query writes the request target ("/a/b?q=1").
+template <std::output_iterator<char> OutputIterator>
+OutputIterator compose_to (parts const& p, field_mask const fields, OutputIterator out) {
+  if (p.scheme.has_value () && includes (fields, field_mask::scheme)) {
+    out = details::compose_string (*p.scheme, out);
+    *(out++) = ':';
+  }
+  auto const with_authority = p.authority.has_value () && includes (fields, field_mask::authority);
+  if (with_authority) {
+    *(out++) = '/';
+    *(out++) = '/';
+    out = details::compose_authority (*p.authority, fields, out);
+  }
+  if (includes (fields, field_mask::path)) {
+    if (with_authority && !p.path.empty () && !p.path.absolute) {
+      *(out++) = '/';
+    }
+    out = details::compose_path (p.path, out);
+  }
+  if (p.query.has_value () && includes (fields, field_mask::query)) {
+    *(out++) = '?';
+    out = details::compose_string (*p.query, out);
+  }
+  if (p.fragment.has_value () && includes (fields, field_mask::fragment)) {
+    *(out++) = '#';
+    out = details::compose_string (*p.fragment, out);
+  }
+  return out;
+}
+
+/// Writes the text of the URI described by \p p to \p out. Returns the
+/// iterator that follows the last character written. Nothing is allocated.
+template <std::output_iterator<char> OutputIterator>
+OutputIterator compose_to (parts const& p, OutputIterator out) {
+  return compose_to (p, field_mask::all, out);
+}
+
+/// Writes the text of the URI described by \p p to \p buffer. Returns the
+/// number of characters written or std::nullopt, having written nothing, if
+/// \p buffer is smaller than composed_size(p). No terminating null character
+/// is written.
+std::optional<std::size_t> compose_into (parts const& p, std::span<char> buffer) noexcept;
+
+/// Removes the "." and ".." segments from \p path, a path in text form, as
+/// described by RFC 3986 section 5.2.4, and writes the result to \p buffer.
+/// The result is never longer than \p path. Returns the number of characters
+/// written or std::nullopt, having written nothing, if \p buffer is smaller
+/// than \p path. A path without dot segments is copied unchanged.
+std::optional<std::size_t> remove_dot_segments (std::string_view path, std::span<char> buffer) noexcept;
+/// Returns \p path with its "." and ".." segments removed.
+std::string remove_dot_segments (std::string_view path);
+
+/// Returns the text of the URI described by \p p. The string is allocated
+/// once at its final size.
 std::string compose (parts const& p);
 std::ostream& compose (std::ostream& os, parts const& p);
 
+/// Resolves \p reference against \p base and writes the text of the target
+/// URI to \p out. Returns the iterator that follows the last character
+/// written or std::nullopt, having written nothing, if \p base is not a valid
+/// URI or \p reference is not a valid URI reference. The intermediate path
+/// segments are normally held on the stack.
+template <std::output_iterator<char> OutputIterator>
+std::optional<OutputIterator> join_to (std::string_view const base, std::string_view const reference,
+                                       OutputIterator out, bool const strict = true) {
+  std::array<std::byte, 512> buffer;
+  std::pmr::monotonic_buffer_resource arena{buffer.data (), buffer.size ()};
+  auto const target = join (base, reference, strict, &arena);
+  if (!target) {
+    return std::nullopt;
+  }
+  return compose_to (*target, out);
+}
+
+/// Resolves \p reference against \p base and returns the text of the target
+/// URI. This is join_to() writing to a std::string. Returns std::nullopt if \p
+/// base is not a valid URI or \p reference is not a valid URI reference.
+std::optional<std::string> join_to_string (std::string_view base, std::string_view reference, bool strict = true);
+
 }  // end namespace uri
 
 #endif  // URI_URI_HPP
@@ -0,0 +1,177 @@
+//===- lib/uri/archive.cpp ------------------------------------------------===//
+//*                 _     _            *
+//*   __ _ _ __ ___| |__ (_)_   _____  *
+//*  / _` | '__/ __| '_ \| \ \ / / _ \ *
+//* | (_| | | | (__| | | | |\ V /  __/ *
+//*  \__,_|_|  \___|_| |_|_| \_/ \___| *
+//*                                    *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/archive.hpp"
+
+#include <limits>
+#include <ostream>
+
+namespace {
+
+using layout = uri::details::archive_layout;
+using range = uri::compact_parts::range;
+
+using uri::details::compact_parts_members;
+
+// The byte offsets of the fields of a record.
+constexpr auto text_offset_field = std::size_t{0};
+constexpr auto text_length_field = std::size_t{8};
+constexpr auto flags_field = std::size_t{12};
+constexpr auto ranges_field = std::size_t{16};
+static_assert (ranges_field + compact_parts_members.size () * 8 == layout::record_size);
+
+constexpr auto absolute_flag = std::uint32_t{1};
+
+/// Appends the little-endian representation of \p value to \p out.
+template <typename T> void append_le (std::vector<std::byte>& out, T const value) {
+  for (auto shift = 0U; shift < sizeof (T) * 8U; shift += 8U) {
+    out.push_back (static_cast<std::byte> ((value >> shift) & 0xFFU));
+  }
+}
+/// Writes the little-endian representation of \p value to \p out.
+template <typename T> void write_le (std::ostream& os, T const value) {
+  for (auto shift = 0U; shift < sizeof (T) * 8U; shift += 8U) {
+    os.put (static_cast<char> ((value >> shift) & 0xFFU));
+  }
+}
+/// Reads a little-endian value from \p p.
+template <typename T> T load_le (std::byte const* const p) noexcept {
+  auto result = T{0};
+  for (auto index = std::size_t{0}; index < sizeof (T); ++index) {
+    result |= static_cast<T> (static_cast<T> (p[index]) << (index * 8U));
+  }
+  return result;
+}
+
+}  // end anonymous namespace
+
+namespace uri {
+
+// archive error category
+// ~~~~~~~~~~~~~~~~~~~~~~
+char const* archive_error_category::name () const noexcept {
+  return "uri archive";
+}
+std::string archive_error_category::message (int const error) const {
+  switch (static_cast<archive_error> (error)) {
+  case archive_error::bad_magic: return "bad magic number";
+  case archive_error::bad_version: return "unsupported version";
+  case archive_error::truncated: return "archive is truncated";
+  case archive_error::none: return "unknown error";
+  default: return "unknown error";
+  }
+}
+std::error_code make_error_code (archive_error const e) {
+  static archive_error_category category;
+  return {static_cast<int> (e), category};
+}
+
+// archive writer
+// ~~~~~~~~~~~~~~
+bool archive_writer::push_back (std::string_view const source, parts const& p) {
+  auto const c = compact (p, source);
+  if (!c || text_.size () > std::numeric_limits<std::uint64_t>::max () - source.size ()) {
+    return false;
+  }
+  append_le (records_, static_cast<std::uint64_t> (text_.size ()));
+  append_le (records_, static_cast<std::uint32_t> (source.size ()));
+  append_le (records_, c->absolute ? absolute_flag : std::uint32_t{0});
+  for (auto const member : compact_parts_members) {
+    append_le (records_, ((*c).*member).offset);
+    append_le (records_, ((*c).*member).length);
+  }
+  text_ += source;
+  return true;
+}
+
+std::ostream& archive_writer::write (std::ostream& os) const {
+  os.write (layout::magic.data (), static_cast<std::streamsize> (layout::magic.size ()));
+  write_le (os, layout::version);
+  write_le (os, static_cast<std::uint32_t> (layout::record_size));
+  write_le (os, static_cast<std::uint64_t> (this->size ()));
+  write_le (os, static_cast<std::uint64_t> (text_.size ()));
+  os.write (reinterpret_cast<char const*> (records_.data ()), static_cast<std::streamsize> (records_.size ()));
+  os.write (text_.data (), static_cast<std::streamsize> (text_.size ()));
+  return os;
+}
+
+// archive
+// ~~~~~~~
+std::variant<std::error_code, archive> archive::open (std::span<std::byte const> const bytes) {
+  if (bytes.size () < layout::header_size) {
+    return make_error_code (archive_error::truncated);
+  }
+  if (std::string_view{reinterpret_cast<char const*> (bytes.data ()), layout::magic.size ()} != layout::magic) {
+    return make_error_code (archive_error::bad_magic);
+  }
+  if (load_le<std::uint32_t> (bytes.data () + 8) != layout::version ||
+      load_le<std::uint32_t> (bytes.data () + 12) != layout::record_size) {
+    return make_error_code (archive_error::bad_version);
+  }
+  auto const count = load_le<std::uint64_t> (bytes.data () + 16);
+  auto const text_size = load_le<std::uint64_t> (bytes.data () + 24);
+  auto const available = bytes.size () - layout::header_size;
+  if (count > available / layout::record_size || text_size > available - count * layout::record_size) {
+    return make_error_code (archive_error::truncated);
+  }
+  auto const records_size = static_cast<std::size_t> (count) * layout::record_size;
+  auto const records = bytes.subspan (layout::header_size, records_size);
+  auto const text = bytes.subspan (layout::header_size + records_size, static_cast<std::size_t> (text_size));
+  return archive{records, std::string_view{reinterpret_cast<char const*> (text.data ()), text.size ()},
+                 static_cast<std::size_t> (count)};
+}
+
+std::optional<std::string_view> archive::source (std::size_t const index) const noexcept {
+  if (index >= count_) {
+    return std::nullopt;
+  }
+  auto const* const record = records_.data () + index * layout::record_size;
+  auto const offset = load_le<std::uint64_t> (record + text_offset_field);
+  auto const length = load_le<std::uint32_t> (record + text_length_field);
+  if (offset > text_.size () || length > text_.size () - offset) {
+    return std::nullopt;
+  }
+  return text_.substr (static_cast<std::size_t> (offset), length);
+}
+
+compact_parts archive::bounds (std::size_t const index) const noexcept {
+  compact_parts result;
+  if (index >= count_) {
+    return result;
+  }
+  auto const* const record = records_.data () + index * layout::record_size;
+  result.absolute = (load_le<std::uint32_t> (record + flags_field) & absolute_flag) != 0U;
+  auto const* r = record + ranges_field;
+  for (auto const member : compact_parts_members) {
+    (result.*member).offset = load_le<std::uint32_t> (r);
+    (result.*member).length = load_le<std::uint32_t> (r + 4);
+    r += 8;
+  }
+  return result;
+}
+
+std::optional<parts> archive::at (std::size_t const index, std::pmr::memory_resource* const resource) const {
+  // source() rejects an index which is out of range.
+  auto const src = this->source (index);
+  if (!src) {
+    return std::nullopt;
+  }
+  auto const b = this->bounds (index);
+  for (auto const member : compact_parts_members) {
+    if (auto const& r = b.*member; r.has_value () && (r.offset > src->size () || r.length > src->size () - r.offset)) {
+      return std::nullopt;
+    }
+  }
+  return expand (b, *src, resource);
+}
+
+}  // end namespace uri
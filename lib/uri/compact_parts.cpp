@@ -0,0 +1,125 @@
+//===- lib/uri/compact_parts.cpp ------------------------------------------===//
+//*                                       _                      _        *
+//*   ___ ___  _ __ ___  _ __   __ _  ___| |_   _ __   __ _ _ __| |_ ___  *
+//*  / __/ _ \| '_ ` _ \| '_ \ / _` |/ __| __| | '_ \ / _` | '__| __/ __| *
+//* | (_| (_) | | | | | | |_) | (_| | (__| |_  | |_) | (_| | |  | |_\__ \ *
+//*  \___\___/|_| |_| |_| .__/ \__,_|\___|\__| | .__/ \__,_|_|   \__|___/ *
+//*                     |_|                    |_|                        *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/compact_parts.hpp"
+
+namespace {
+
+using range = uri::compact_parts::range;
+
+/// Returns the offset of \p str within \p source or std::nullopt if it does
+/// not lie entirely within \p source.
+std::optional<std::uint32_t> offset_of (std::string_view const str, std::string_view const source) {
+  if (!uri::details::within (source, str)) {
+    return std::nullopt;
+  }
+  return static_cast<std::uint32_t> (str.data () - source.data ());
+}
+
+/// Converts \p str to a range within \p source. An empty string need not
+/// refer to \p source: it is recorded at offset 0.
+std::optional<range> to_range (std::string_view const str, std::string_view const source) {
+  if (str.empty ()) {
+    return range{0, 0};
+  }
+  if (auto const offset = offset_of (str, source)) {
+    return range{*offset, static_cast<std::uint32_t> (str.length ())};
+  }
+  return std::nullopt;
+}
+
+/// Converts an optional string to a range: an absent string becomes the absent
+/// range.
+std::optional<range> to_range (std::optional<std::string_view> const& str, std::string_view const source) {
+  return str.has_value () ? to_range (*str, source) : std::optional<range>{range{}};
+}
+
+/// Returns the range spanned by the path segments of \p path.
+std::optional<range> path_range (struct uri::parts::path const& path, std::string_view const source) {
+  auto const& segments = path.segments;
+  if (segments.empty ()) {
+    return range{};
+  }
+  // Each segment, even an empty one, must be at its expected place in the
+  // source so that the path can be split back into the same segments.
+  auto const first = offset_of (segments.front (), source);
+  if (!first) {
+    return std::nullopt;
+  }
+  auto pos = std::size_t{*first};
+  for (auto it = segments.begin (), end = segments.end (); it != end; ++it) {
+    if (it != segments.begin ()) {
+      if (pos >= source.length () || source[pos] != '/') {
+        return std::nullopt;
+      }
+      ++pos;
+    }
+    if (offset_of (*it, source) != pos || it->find ('/') != std::string_view::npos) {
+      return std::nullopt;
+    }
+    pos += it->length ();
+  }
+  return range{*first, static_cast<std::uint32_t> (pos - *first)};
+}
+
+}  // end anonymous namespace
+
+namespace uri {
+
+std::optional<compact_parts> compact (parts const& p, std::string_view const source) {
+  if (source.length () >= range::absent) {
+    return std::nullopt;
+  }
+  compact_parts result;
+  auto ok = true;
+  auto const set = [&ok] (range& r, std::optional<range> const& value) {
+    if (value) {
+      r = *value;
+    } else {
+      ok = false;
+    }
+  };
+  set (result.scheme, to_range (p.scheme, source));
+  if (p.authority) {
+    set (result.userinfo, to_range (p.authority->userinfo, source));
+    set (result.host, to_range (p.authority->host, source));
+    set (result.port, to_range (p.authority->port, source));
+  }
+  set (result.path, path_range (p.path, source));
+  set (result.query, to_range (p.query, source));
+  set (result.fragment, to_range (p.fragment, source));
+  result.absolute = p.path.absolute;
+  if (!ok) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+parts expand (compact_parts const& c, std::string_view const source, std::pmr::memory_resource* const resource) {
+  parts result = make_parts (resource);
+  result.scheme = c.scheme.view (source);
+  if (auto const host = c.host.view (source)) {
+    auto& auth = result.authority.emplace ();
+    auth.userinfo = c.userinfo.view (source);
+    auth.host = *host;
+    auth.port = c.port.view (source);
+  }
+  result.path.absolute = c.absolute;
+  if (auto const path = c.path.view (source)) {
+    details::split_segments (*path, result.path.segments);
+  }
+  result.query = c.query.view (source);
+  result.fragment = c.fragment.view (source);
+  return result;
+}
+
+}  // end namespace uri
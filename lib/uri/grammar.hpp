@@ -0,0 +1,709 @@
+//===- lib/uri/grammar.hpp --------------------------------*- mode: C++ -*-===//
+//*                                                  *
+//*   __ _ _ __ __ _ _ __ ___  _ __ ___   __ _ _ __  *
+//*  / _` | '__/ _` | '_ ` _ \| '_ ` _ \ / _` | '__| *
+//* | (_| | | | (_| | | | | | | | | | | | (_| | |    *
+//*  \__, |_|  \__,_|_| |_| |_|_| |_| |_|\__,_|_|    *
+//*  |___/                                           *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+/// \file grammar.hpp
+/// \brief A compile-time flavour of the rule class.
+///
+/// The templates in this file provide the same vocabulary as the rule class
+/// (concatenation, alternatives, optional sequences and repetition) but each
+/// grammar production is a type rather than a function which builds rule
+/// objects at run time. The compiler can therefore flatten a complete grammar
+/// into straight-line code with no type erasure.
+///
+/// ## Concatenation
+///
+/// A definition such as: `C = A B` would be translated as:
+///
+/// ~~~cpp
+/// using C = concat<A, B>;
+/// ~~~
+///
+/// ## Alternative
+///
+/// A definition such as: `C = A / B` would be translated as:
+///
+/// ~~~cpp
+/// using C = alternative<A, B>;
+/// ~~~
+///
+/// ## Optional Sequence
+///
+/// An optional sequence such as `B = [A]` can implemented as:
+///
+/// ~~~cpp
+/// using B = optional<A>;
+/// ~~~
+///
+/// ## Repetition
+///
+/// `<a>*<b>Rule` is implemented using `star<Rule, a, b>`. For example: `h16 =
+/// 1*4HEXDIG` can be implemented as:
+///
+/// ~~~cpp
+/// using h16 = star<hexdig, 1, 4>;
+/// ~~~
+///
+/// ## Acceptors
+///
+/// `accept<Rule, Function>` records a call to `Function` with the text matched
+/// by `Rule`. As with the rule class, the recorded functions are called only
+/// once the complete input has been matched by `parse()`. `Function` must be a
+/// pointer to a function with the signature `void (Target&, std::string_view)`.
+///
+/// ## Named Productions
+///
+/// `named<"name", Rule>` matches `Rule`. If the production observer hook is
+/// enabled (see observer.hpp), each evaluation is reported using the given
+/// name.
+///
+/// ## Memoization
+///
+/// Wrapping a production in `memo<>` allows a context created with
+/// memoization::on to record the outcome of that production at each input
+/// position. If an enclosing alternative backtracks and the production is
+/// attempted again at the same position, the recorded result (including any
+/// acceptors) is replayed rather than the input being matched a second time.
+/// With memoization::off, `memo<Rule>` is identical to `Rule`.
+///
+/// The gotchas described in rule.hpp apply equally here: `star` is greedy and
+/// `alternative` commits to the first alternative that matches.
+
+#ifndef URI_GRAMMAR_HPP
+#define URI_GRAMMAR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "uri/ascii.hpp"
+#include "uri/observer.hpp"
+#include "uri/split_options.hpp"
+
+namespace uri::grammar {
+
+/// A cursor records the position of the next character to be matched within
+/// the input string.
+class cursor {
+public:
+  constexpr explicit cursor (std::string_view const input) noexcept : input_{input} {}
+
+  [[nodiscard]] constexpr std::string_view input () const noexcept { return input_; }
+  [[nodiscard]] constexpr std::size_t position () const noexcept { return pos_; }
+  [[nodiscard]] constexpr bool at_end () const noexcept { return pos_ >= input_.length (); }
+  [[nodiscard]] constexpr char peek () const noexcept {
+    assert (!this->at_end ());
+    return input_[pos_];
+  }
+  constexpr void advance (std::size_t const n = 1) noexcept {
+    assert (n <= input_.length () - pos_);
+    pos_ += n;
+  }
+
+protected:
+  constexpr void seek (std::size_t const pos) noexcept { pos_ = pos; }
+
+private:
+  std::string_view input_;
+  std::size_t pos_ = 0;
+};
+
+/// A context which matches input without recording any acceptor functions. It
+/// can be used at compile time.
+class recognizer : public cursor {
+public:
+  struct mark {
+    std::size_t pos = 0;
+  };
+
+  using cursor::cursor;
+
+  [[nodiscard]] constexpr mark save () const noexcept { return {this->position ()}; }
+  constexpr void restore (mark const& m) noexcept { this->seek (m.pos); }
+
+  template <typename Function>
+  // NOLINTNEXTLINE(hicpp-named-parameter,readability-named-parameter)
+  constexpr void record (Function, std::size_t) const noexcept {}
+};
+
+namespace details {
+
+/// A string literal which can be used as a template argument.
+template <std::size_t N>
+struct fixed_string {
+  // NOLINTNEXTLINE(hicpp-explicit-conversions,google-explicit-constructor)
+  constexpr fixed_string (char const (&str)[N]) noexcept { std::copy_n (str, N, value.begin ()); }
+  [[nodiscard]] constexpr std::string_view view () const noexcept { return {value.data (), N - 1}; }
+  std::array<char, N> value{};
+};
+
+/// Provides an identifier for the production \p Rule which is unique within
+/// the program.
+template <typename Rule>
+struct rule_id {
+  static constexpr char tag = 0;
+  static constexpr void const* value = &tag;
+};
+
+}  // end namespace details
+
+/// A context which matches input and records the acceptor functions to be
+/// called if the match is successful.
+///
+/// Storage for the first inline_capacity records is held within the context
+/// object itself. Larger logs obtain memory from the upstream memory resource.
+template <typename Target>
+class context : public cursor {
+public:
+  using action = void (*) (Target&, std::string_view);
+  struct mark {
+    std::size_t pos = 0;
+    std::size_t actions = 0;
+  };
+  static constexpr std::size_t inline_capacity = 64;
+
+  explicit context (std::string_view const input,
+                    std::pmr::memory_resource* const upstream = std::pmr::get_default_resource (),
+                    memoization const memo = memoization::off)
+      : cursor{input},
+        resource_{buffer_.data (), buffer_.size (), upstream},
+        actions_{&resource_},
+        memo_{memo == memoization::on},
+        memo_heads_{&resource_},
+        memo_entries_{&resource_},
+        memo_actions_{&resource_} {
+    actions_.reserve (inline_capacity);
+  }
+  context (context const&) = delete;
+  context (context&&) noexcept = delete;
+  ~context () noexcept = default;
+
+  context& operator= (context const&) = delete;
+  context& operator= (context&&) noexcept = delete;
+
+  [[nodiscard]] mark save () const noexcept { return {this->position (), actions_.size ()}; }
+  void restore (mark const& m) {
+    assert (m.pos <= this->position ());
+    rescanned_ += this->position () - m.pos;
+    if (rescanned_ > budget_) {
+      exhausted_ = true;
+    }
+    this->seek (m.pos);
+    actions_.resize (m.actions);
+  }
+
+  /// Limits the number of characters which may be given up by backtracking
+  /// (and may therefore be scanned again). Once the budget is exhausted, the
+  /// context behaves as if it has reached the end of the input so that any
+  /// remaining alternatives fail quickly, and done() returns false.
+  void set_budget (std::size_t const budget) noexcept { budget_ = budget; }
+  /// Returns true if the budget set by set_budget() has been exceeded.
+  [[nodiscard]] bool exhausted () const noexcept { return exhausted_; }
+  /// Returns the number of characters given up by backtracking so far.
+  [[nodiscard]] std::size_t rescanned () const noexcept { return rescanned_; }
+
+  [[nodiscard]] bool at_end () const noexcept { return exhausted_ || cursor::at_end (); }
+
+  /// Records a call to \p function with the text between \p first and the
+  /// current position.
+  void record (action const function, std::size_t const first) {
+    assert (first <= this->position ());
+    actions_.push_back ({function, this->input ().substr (first, this->position () - first)});
+  }
+
+  /// Evaluates \p Rule at the current position. If memoization is enabled and
+  /// \p Rule has previously been evaluated at this position, the earlier result
+  /// is replayed instead.
+  template <typename Rule>
+  bool memoized () {
+    if (!memo_) {
+      return Rule::match (*this);
+    }
+    auto const id = details::rule_id<Rule>::value;
+    auto const pos = this->position ();
+    if (memo_heads_.empty ()) {
+      memo_heads_.resize (this->input ().length () + 1U, 0U);
+    }
+    // Only the entries recorded at this position are visited. There is at most
+    // one for each memo<> production in the grammar.
+    for (auto index = memo_heads_[pos]; index != 0U; index = memo_entries_[index - 1U].next) {
+      auto const& entry = memo_entries_[index - 1U];
+      if (entry.id != id) {
+        continue;
+      }
+      if (!entry.matched) {
+        return false;
+      }
+      auto const first = memo_actions_.begin () + static_cast<std::ptrdiff_t> (entry.first_action);
+      actions_.insert (actions_.end (), first, first + static_cast<std::ptrdiff_t> (entry.num_actions));
+      this->seek (entry.end);
+      return true;
+    }
+    auto const m = this->save ();
+    memo_entry entry;
+    entry.id = id;
+    entry.matched = Rule::match (*this);
+    if (entry.matched) {
+      entry.end = this->position ();
+      entry.first_action = memo_actions_.size ();
+      entry.num_actions = actions_.size () - m.actions;
+      auto const first = actions_.begin () + static_cast<std::ptrdiff_t> (m.actions);
+      memo_actions_.insert (memo_actions_.end (), first, actions_.end ());
+    }
+    // Matching Rule may have recorded entries for nested productions at this
+    // position, so the chain is extended only now.
+    entry.next = memo_heads_[pos];
+    memo_entries_.push_back (entry);
+    memo_heads_[pos] = memo_entries_.size ();
+    return entry.matched;
+  }
+
+  /// If the complete input has been matched, calls each of the recorded
+  /// functions in turn.
+  bool done (Target& target) const {
+    if (exhausted_ || !cursor::at_end ()) {
+      return false;
+    }
+    for (auto const& [function, str] : actions_) {
+      function (target, str);
+    }
+    return true;
+  }
+
+private:
+  struct record_type {
+    action function;
+    std::string_view str;
+  };
+  struct memo_entry {
+    void const* id = nullptr;  ///< The production (see details::rule_id<>).
+    std::size_t next = 0;      ///< One more than the index of the previous entry at the same position, or 0.
+    bool matched = false;
+    std::size_t end = 0;           ///< The position following a successful match.
+    std::size_t first_action = 0;  ///< Index within memo_actions_ of the first recorded action.
+    std::size_t num_actions = 0;   ///< The number of actions recorded by the match.
+  };
+
+  alignas (record_type) std::array<std::byte, inline_capacity * sizeof (record_type)> buffer_;
+  std::pmr::monotonic_buffer_resource resource_;
+  std::pmr::vector<record_type> actions_;
+
+  std::size_t budget_ = std::numeric_limits<std::size_t>::max ();
+  std::size_t rescanned_ = 0;
+  bool exhausted_ = false;
+
+  bool memo_;
+  /// For each input position, one more than the index within memo_entries_ of
+  /// the most recent entry recorded there, or 0 if there is none. Allocated by
+  /// the first call to memoized().
+  std::pmr::vector<std::size_t> memo_heads_;
+  std::pmr::vector<memo_entry> memo_entries_;
+  std::pmr::vector<record_type> memo_actions_;
+};
+
+/// Matches a single character for which \p Predicate returns true.
+template <auto Predicate>
+struct char_if {
+  static constexpr bool test (char const c) noexcept { return Predicate (c); }
+
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    if (ctx.at_end () || !test (ctx.peek ())) {
+      return false;
+    }
+    ctx.advance ();
+    return true;
+  }
+};
+
+/// Matches the character \p C. As in ABNF, the comparison is case-insensitive.
+template <char C>
+struct single_char {
+  static constexpr bool test (char const c) noexcept { return ascii::to_lower (c) == ascii::to_lower (C); }
+
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    if (ctx.at_end () || !test (ctx.peek ())) {
+      return false;
+    }
+    ctx.advance ();
+    return true;
+  }
+};
+
+/// Matches a single character in the range [\p First, \p Last]. The comparison
+/// is case-insensitive.
+template <char First, char Last>
+struct char_range {
+  static constexpr bool test (char const c) noexcept {
+    auto const lc = ascii::to_lower (c);
+    return lc >= ascii::to_lower (First) && lc <= ascii::to_lower (Last);
+  }
+
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    if (ctx.at_end () || !test (ctx.peek ())) {
+      return false;
+    }
+    ctx.advance ();
+    return true;
+  }
+};
+
+using alpha = char_if<&ascii::is_alpha>;
+using digit = char_if<&ascii::is_digit>;
+using hexdig = char_if<&ascii::is_hexdig>;
+
+/// Matches each of \p Rules in sequence.
+template <typename... Rules>
+struct concat {
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    return (Rules::match (ctx) && ...);
+  }
+};
+
+/// Tries each of \p Rules from left to right and stops as soon as one is
+/// matched.
+template <typename... Rules>
+struct alternative {
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    auto const m = ctx.save ();
+    auto const attempt = [&ctx, &m]<typename Rule> () {
+      if (Rule::match (ctx)) {
+        return true;
+      }
+      ctx.restore (m);
+      return false;
+    };
+    return (attempt.template operator()<Rules> () || ...);
+  }
+};
+
+/// Matches \p Rule if possible. Always succeeds.
+template <typename Rule>
+struct optional {
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    if (auto const m = ctx.save (); !Rule::match (ctx)) {
+      ctx.restore (m);
+    }
+    return true;
+  }
+};
+
+template <typename Rule>
+struct memo;
+template <details::fixed_string Name, typename Rule>
+struct named;
+
+namespace details {
+
+/// A set of 256 bits, one for each possible value of a char.
+class char_set {
+public:
+  constexpr char_set () noexcept = default;
+
+  /// Builds the set of characters for which \p predicate returns true.
+  template <typename Predicate>
+  static constexpr char_set from (Predicate predicate) noexcept {
+    char_set result;
+    for (auto c = 0U; c < 256U; ++c) {
+      if (predicate (static_cast<char> (c))) {
+        result.bits_[c / 64U] |= std::uint64_t{1} << (c % 64U);
+      }
+    }
+    return result;
+  }
+  static constexpr char_set all () noexcept {
+    return from ([] (char) { return true; });
+  }
+
+  [[nodiscard]] constexpr bool test (char const c) const noexcept {
+    auto const index = static_cast<unsigned char> (c);
+    return (bits_[index / 64U] >> (index % 64U)) & 1U;
+  }
+  [[nodiscard]] constexpr bool empty () const noexcept {
+    return std::all_of (bits_.begin (), bits_.end (), [] (std::uint64_t const w) { return w == 0U; });
+  }
+
+  constexpr char_set operator| (char_set const& rhs) const noexcept {
+    char_set result;
+    for (auto ctr = std::size_t{0}; ctr < bits_.size (); ++ctr) {
+      result.bits_[ctr] = bits_[ctr] | rhs.bits_[ctr];
+    }
+    return result;
+  }
+  constexpr char_set operator- (char_set const& rhs) const noexcept {
+    char_set result;
+    for (auto ctr = std::size_t{0}; ctr < bits_.size (); ++ctr) {
+      result.bits_[ctr] = bits_[ctr] & ~rhs.bits_[ctr];
+    }
+    return result;
+  }
+
+private:
+  std::array<std::uint64_t, 4> bits_{};
+};
+
+/// True if \p Rule always matches exactly one character and has no side
+/// effects: that is, it is char_if, single_char, char_range, or an
+/// alternative composed only of those.
+template <typename Rule>
+struct is_char_class : std::bool_constant<requires (char c) { Rule::test (c); }> {};
+template <typename... Rules>
+struct is_char_class<alternative<Rules...>> : std::bool_constant<(is_char_class<Rules>::value && ...)> {};
+// A named production must be evaluated individually if it is being observed.
+template <fixed_string Name, typename Rule>
+struct is_char_class<named<Name, Rule>> : std::bool_constant<!observe_productions && is_char_class<Rule>::value> {};
+
+/// The set of characters matched by a rule for which is_char_class is true.
+template <typename Rule>
+struct class_set {
+  static constexpr char_set value = char_set::from ([] (char const c) { return Rule::test (c); });
+};
+template <typename... Rules>
+struct class_set<alternative<Rules...>> {
+  static constexpr char_set value = (class_set<Rules>::value | ...);
+};
+template <fixed_string Name, typename Rule>
+struct class_set<named<Name, Rule>> : class_set<Rule> {};
+
+/// A superset of the characters with which a match of \p Rule can begin. The
+/// answer is conservative: where it is not known, every character is included.
+template <typename Rule>
+struct first_set {
+  static constexpr char_set value = [] {
+    if constexpr (is_char_class<Rule>::value) {
+      return class_set<Rule>::value;
+    } else {
+      return char_set::all ();
+    }
+  }();
+};
+template <typename First, typename... Rest>
+struct first_set<concat<First, Rest...>> {
+  // A character class cannot match the empty string so the first character of
+  // the concatenation must be matched by First.
+  static constexpr char_set value = is_char_class<First>::value ? class_set<First>::value : char_set::all ();
+};
+template <typename... Rules>
+struct first_set<alternative<Rules...>> {
+  static constexpr char_set value = (first_set<Rules>::value | ...);
+};
+template <typename Rule>
+struct first_set<memo<Rule>> : first_set<Rule> {};
+template <fixed_string Name, typename Rule>
+struct first_set<named<Name, Rule>> : first_set<Rule> {};
+
+/// The set of characters for which a single match of \p Rule is known to
+/// consume exactly that one character with no side effects. For an
+/// alternative, a character is included only if it is in the run_set of the
+/// first member which could begin with it. This preserves the ordered choice:
+/// an earlier, longer member is always given the opportunity to match.
+template <typename Rule>
+struct run_set {
+  static constexpr char_set value = [] {
+    if constexpr (is_char_class<Rule>::value) {
+      return class_set<Rule>::value;
+    } else {
+      return char_set{};
+    }
+  }();
+};
+template <typename... Rules>
+struct run_set<alternative<Rules...>> {
+  static constexpr char_set value = [] {
+    char_set result;
+    char_set shadow;
+    (
+      [&]<typename Rule> () {
+        result = result | (run_set<Rule>::value - shadow);
+        shadow = shadow | first_set<Rule>::value;
+      }.template operator()<Rules> (),
+      ...);
+    return result;
+  }();
+};
+
+template <fixed_string Name, typename Rule>
+struct run_set<named<Name, Rule>> {
+  static constexpr char_set value = observe_productions ? char_set{} : run_set<Rule>::value;
+};
+
+}  // end namespace details
+
+/// Matches at least \p Min and at most \p Max repetitions of \p Rule.
+///
+/// Where some or all of the characters matched by \p Rule can be identified
+/// from a single lookup (see details::run_set), runs of such characters are
+/// consumed by a tight loop over the input rather than by repeated calls to
+/// Rule::match(). Rule::match() is used only for the remaining characters.
+template <typename Rule, unsigned Min = 0, unsigned Max = std::numeric_limits<unsigned>::max ()>
+struct star {
+  static_assert (Min <= Max);
+
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    if constexpr (details::run_set<Rule>::value.empty ()) {
+      return match_each (ctx);
+    } else {
+      return match_runs (ctx);
+    }
+  }
+
+private:
+  template <typename Context>
+  static constexpr bool match_runs (Context& ctx) {
+    constexpr auto const& set = details::run_set<Rule>::value;
+    auto const input = ctx.input ();
+    auto count = 0U;
+    // The rule is tried even at the end of the input: it may match the empty
+    // string or record an acceptor, just as it would in match_each().
+    while (count < Max) {
+      // Consume the longest run of characters in the set.
+      auto pos = ctx.position ();
+      auto const limit = pos + std::min (static_cast<std::size_t> (Max - count), input.length () - pos);
+      auto const first = pos;
+      while (pos < limit && set.test (input[pos])) {
+        ++pos;
+      }
+      ctx.advance (pos - first);
+      count += static_cast<unsigned> (pos - first);
+      if constexpr (details::is_char_class<Rule>::value) {
+        break;  // The run covers every possible match.
+      } else {
+        if (count >= Max) {
+          break;
+        }
+        // Try a single match of the rule at a character which is not part of
+        // the run.
+        auto const m = ctx.save ();
+        if (!Rule::match (ctx)) {
+          ctx.restore (m);
+          break;
+        }
+        ++count;
+        if (ctx.position () == m.pos) {
+          break;  // An empty match would repeat forever.
+        }
+      }
+    }
+    return count >= Min;
+  }
+
+  template <typename Context>
+  static constexpr bool match_each (Context& ctx) {
+    auto count = 0U;
+    for (; count < Max; ++count) {
+      auto const m = ctx.save ();
+      if (!Rule::match (ctx)) {
+        ctx.restore (m);
+        break;
+      }
+      if (ctx.position () == m.pos) {
+        // An empty match would repeat forever.
+        ++count;
+        break;
+      }
+    }
+    return count >= Min;
+  }
+};
+
+/// Matches the empty string if \p Rule does _not_ match.
+template <typename Rule>
+struct not_followed_by {
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    auto const m = ctx.save ();
+    bool const matched = Rule::match (ctx);
+    ctx.restore (m);
+    return !matched;
+  }
+};
+
+/// Matches \p Rule and records a call to \p Function with the matched text.
+template <typename Rule, auto Function>
+struct accept {
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    auto const first = ctx.position ();
+    if (!Rule::match (ctx)) {
+      return false;
+    }
+    ctx.record (Function, first);
+    return true;
+  }
+};
+
+/// Matches \p Rule. Where the context supports memoization, the outcome of
+/// evaluating \p Rule at a position is recorded and reused if the same
+/// production is later attempted at the same position (typically after an
+/// enclosing alternative has backtracked).
+template <typename Rule>
+struct memo {
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    if constexpr (requires { ctx.template memoized<Rule> (); }) {
+      return ctx.template memoized<Rule> ();
+    } else {
+      return Rule::match (ctx);
+    }
+  }
+};
+
+/// Matches \p Rule. If observe_productions is true, the outcome is reported to
+/// the thread's production observer using \p Name.
+template <details::fixed_string Name, typename Rule>
+struct named {
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    if constexpr (observe_productions) {
+      if (!std::is_constant_evaluated ()) {
+        auto const first = ctx.position ();
+        bool const ok = Rule::match (ctx);
+        uri::details::production_evaluated (Name.view (), ok, ok ? ctx.position () - first : 0);
+        return ok;
+      }
+    }
+    return Rule::match (ctx);
+  }
+};
+
+/// Returns true if \p str is matched in its entirety by \p Rule.
+template <typename Rule>
+constexpr bool matches (std::string_view const str) {
+  recognizer ctx{str};
+  return Rule::match (ctx) && ctx.at_end ();
+}
+
+/// If \p str is matched in its entirety by \p Rule, calls the recorded
+/// acceptor functions with \p target and returns true. Memory beyond the
+/// context's inline capacity is obtained from \p upstream.
+template <typename Rule, typename Target>
+bool parse (std::string_view const str, Target& target, memoization const memo = memoization::off,
+            std::pmr::memory_resource* const upstream = std::pmr::get_default_resource ()) {
+  context<Target> ctx{str, upstream, memo};
+  return Rule::match (ctx) && ctx.done (target);
+}
+
+}  // end namespace uri::grammar
+
+#endif  // URI_GRAMMAR_HPP
@@ -0,0 +1,105 @@
+//===- lib/uri/hash.cpp ---------------------------------------------------===//
+//*  _               _      *
+//* | |__   __ _ ___| |__   *
+//* | '_ \ / _` / __| '_ \  *
+//* | | | | (_| \__ \ | | | *
+//* |_| |_|\__,_|___/_| |_| *
+//*                         *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/hash.hpp"
+
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+#include "uri/parts.hpp"
+
+namespace {
+
+using uri::details::hash_bytes;
+using uri::details::hash_k0;
+using uri::details::hash_k1;
+using uri::details::hash_mix;
+
+/// The tags which identify each component.
+enum tag : std::uint64_t {
+  scheme_tag = 1,
+  authority_tag,
+  userinfo_tag,
+  host_tag,
+  port_tag,
+  absolute_tag,
+  segment_tag,
+  query_tag,
+  fragment_tag,
+};
+
+constexpr std::uint64_t absent (std::uint64_t const h, tag const t) noexcept {
+  return hash_mix (h ^ (t * hash_k1));
+}
+std::uint64_t present (std::uint64_t const h, tag const t, std::string_view const str) noexcept {
+  return hash_bytes (str, h ^ (t * hash_k0));
+}
+std::uint64_t optional (std::uint64_t const h, tag const t, std::optional<std::string_view> const& str) noexcept {
+  return str ? present (h, t, *str) : absent (h, t);
+}
+
+std::uint64_t authority (std::uint64_t h, struct uri::parts::authority const& auth) noexcept {
+  h = optional (h, userinfo_tag, auth.userinfo);
+  h = present (h, host_tag, auth.host);
+  return optional (h, port_tag, auth.port);
+}
+std::uint64_t segments (std::uint64_t h, uri::parts::path::segments_type const& segs) noexcept {
+  for (auto const& segment : segs) {
+    h = present (h, segment_tag, segment);
+  }
+  return h;
+}
+std::uint64_t absolute (std::uint64_t const h, bool const abs) noexcept {
+  return hash_mix (h ^ (absolute_tag * hash_k0) ^ static_cast<std::uint64_t> (abs));
+}
+
+}  // end anonymous namespace
+
+namespace uri {
+
+std::uint64_t hash (struct parts::authority const& auth) noexcept {
+  return authority (hash_mix (authority_tag), auth);
+}
+std::uint64_t hash (struct parts::path const& path) noexcept {
+  return segments (absolute (0, path.absolute), path.segments);
+}
+std::uint64_t hash (parts const& p) noexcept {
+  auto h = optional (0, scheme_tag, p.scheme);
+  if (p.authority) {
+    // parts::operator==() ignores the path's absolute flag when both objects
+    // have an authority.
+    h = authority (hash_mix (h ^ (authority_tag * hash_k0)), *p.authority);
+  } else {
+    h = absolute (absent (h, authority_tag), p.path.absolute);
+  }
+  h = segments (h, p.path.segments);
+  h = optional (h, query_tag, p.query);
+  return optional (h, fragment_tag, p.fragment);
+}
+
+std::size_t normalized_hash::operator() (parts const& p) const {
+  std::array<std::byte, 1024> buffer;
+  std::pmr::monotonic_buffer_resource arena{buffer.data (), buffer.size ()};
+  std::pmr::vector<char> store{&arena};
+  return static_cast<std::size_t> (hash (normalize (store, p, &arena)));
+}
+
+bool normalized_equal::operator() (parts const& lhs, parts const& rhs) const {
+  std::array<std::byte, 2048> buffer;
+  std::pmr::monotonic_buffer_resource arena{buffer.data (), buffer.size ()};
+  std::pmr::vector<char> lhs_store{&arena};
+  std::pmr::vector<char> rhs_store{&arena};
+  return normalize (lhs_store, lhs, &arena) == normalize (rhs_store, rhs, &arena);
+}
+
+}  // end namespace uri
@@ -0,0 +1,130 @@
+//===- lib/uri/join_context.cpp -------------------------------------------===//
+//*    _       _                         _            _    *
+//*   (_) ___ (_)_ __     ___ ___  _ __ | |_ _____  _| |_  *
+//*   | |/ _ \| | '_ \   / __/ _ \| '_ \| __/ _ \ \/ / __| *
+//*   | | (_) | | | | | | (_| (_) | | | | ||  __/>  <| |_  *
+//*  _/ |\___/|_|_| |_|  \___\___/|_| |_|\__\___/_/\_\\__| *
+//* |__/                                                   *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/join_context.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace uri {
+
+join_context::join_context (parts const& base, bool const strict, std::pmr::memory_resource* const resource)
+    : base_{make_parts (resource)}, prefix_{resource}, strict_{strict} {
+  base_ = base;
+  // These are the segments produced by the merge step of join(). If the base
+  // URI has an authority and an empty path, the merged path is "/" followed by
+  // the reference's path. Otherwise it is the reference's path appended to all
+  // but the last segment of the base URI's path.
+  if (base_.authority.has_value () && base_.path.empty ()) {
+    prefix_absolute_ = true;
+    return;
+  }
+  prefix_absolute_ = base_.path.absolute;
+  auto const& segments = base_.path.segments;
+  auto last = std::end (segments);
+  if (segments.size () > 1) {
+    std::advance (last, -1);
+  }
+  prefix_.assign (std::begin (segments), last);
+}
+
+std::optional<join_context> join_context::make (std::string_view const base, bool const strict,
+                                                std::pmr::memory_resource* const resource) {
+  auto const p = split (base, resource);
+  if (!p) {
+    return std::nullopt;
+  }
+  return join_context{*p, strict, resource};
+}
+
+void join_context::resolve (parts& target) const {
+  // In "non-strict" mode we ignore a scheme in the reference if it is identical
+  // to the base URI's scheme.
+  if (!strict_ && target.scheme == base_.scheme) {
+    target.scheme.reset ();
+  }
+  if (target.scheme.has_value ()) {
+    target.path.remove_dot_segments ();
+    return;
+  }
+  if (target.authority.has_value ()) {
+    target.path.remove_dot_segments ();
+  } else {
+    auto& segments = target.path.segments;
+    if (segments.empty ()) {
+      target.path.absolute = base_.path.absolute;
+      segments.assign (std::begin (base_.path.segments), std::end (base_.path.segments));
+      if (!target.query.has_value ()) {
+        target.query = base_.query;
+      }
+    } else {
+      if (!target.path.absolute) {
+        // Merge the paths by inserting the precomputed prefix ahead of the
+        // reference's segments.
+        auto const size = segments.size ();
+        segments.resize (size + prefix_.size ());
+        auto const first = std::begin (segments);
+        std::copy_backward (first, first + size, std::end (segments));
+        std::copy (std::begin (prefix_), std::end (prefix_), first);
+        target.path.absolute = prefix_absolute_;
+      }
+      target.path.remove_dot_segments ();
+    }
+    target.authority = base_.authority;
+  }
+  target.scheme = base_.scheme;
+}
+
+void join_context::join (parts const& reference, parts& target) const {
+  if (&reference != &target) {
+    target = reference;
+  }
+  this->resolve (target);
+}
+
+bool join_context::join (std::string_view const reference, parts& target) const {
+  target.scheme.reset ();
+  target.authority.reset ();
+  target.path.absolute = false;
+  target.path.segments.clear ();
+  target.query.reset ();
+  target.fragment.reset ();
+  switch (details::scan (reference, true, target)) {
+  case details::scan_result::success: break;
+  case details::scan_result::failure: return false;
+  case details::scan_result::fallback:
+    if (auto r = split_reference (reference, target.path.segments.get_allocator ().resource ())) {
+      target = std::move (*r);
+      break;
+    }
+    return false;
+  }
+  this->resolve (target);
+  return true;
+}
+
+parts join_context::join (parts const& reference, std::pmr::memory_resource* const resource) const {
+  parts target = make_parts (resource);
+  this->join (reference, target);
+  return target;
+}
+
+std::optional<parts> join_context::join (std::string_view const reference,
+                                         std::pmr::memory_resource* const resource) const {
+  parts target = make_parts (resource);
+  if (!this->join (reference, target)) {
+    return std::nullopt;
+  }
+  return target;
+}
+
+}  // end namespace uri
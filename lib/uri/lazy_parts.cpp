@@ -0,0 +1,198 @@
+//===- lib/uri/lazy_parts.cpp ---------------------------------------------===//
+//*  _                                    _        *
+//* | | __ _ _____   _   _ __   __ _ _ __| |_ ___  *
+//* | |/ _` |_  / | | | | '_ \ / _` | '__| __/ __| *
+//* | | (_| |/ /| |_| | | |_) | (_| | |  | |_\__ \ *
+//* |_|\__,_/___|\__, | | .__/ \__,_|_|   \__|___/ *
+//*              |___/  |_|                        *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/lazy_parts.hpp"
+
+#include <algorithm>
+
+#include "uri/ascii.hpp"
+
+namespace {
+
+using path_type = struct uri::parts::path;
+using range = uri::compact_parts::range;
+using enum uri::ascii::char_class;
+
+constexpr range make_range (std::size_t const first, std::size_t const last) noexcept {
+  return range{static_cast<std::uint32_t> (first), static_cast<std::uint32_t> (last - first)};
+}
+
+/// Returns the position of the first character of \p in at or after \p pos
+/// which is one of the delimiters \p Delims or the length of \p in if there is
+/// none. Unlike std::string_view::find_first_of(), the set of delimiters is
+/// known at compile time.
+template <char... Delims> constexpr std::size_t find_delimiter (std::string_view const in, std::size_t pos) noexcept {
+  auto const length = in.length ();
+  while (pos < length && ((in[pos] != Delims) && ...)) {
+    ++pos;
+  }
+  return pos;
+}
+
+/// Records the boundaries of the userinfo, host and port within the authority
+/// which occupies [first, last) of \p in.
+void authority_bounds (std::string_view const in, std::size_t const first, std::size_t const last,
+                       uri::compact_parts& result) {
+  struct uri::parts::authority auth;
+  uri::details::delimit_authority (in.substr (first, last - first), auth);
+  auto const to_range = [&in] (std::string_view const str) {
+    auto const offset = static_cast<std::size_t> (str.data () - in.data ());
+    return make_range (offset, offset + str.length ());
+  };
+  if (auth.userinfo) {
+    result.userinfo = to_range (*auth.userinfo);
+  }
+  result.host = to_range (auth.host);
+  if (auth.port) {
+    result.port = to_range (*auth.port);
+  }
+}
+
+/// Finds the component boundaries of \p in using the regular expression from
+/// RFC 3986 Appendix B:
+///
+///     ^(([^:/?#]+):)?(//([^/?#]*))?([^?#]*)(\?([^#]*))?(#(.*))?
+std::optional<uri::compact_parts> boundaries (std::string_view const in, bool const reference) {
+  if (in.length () >= range::absent) {
+    return std::nullopt;
+  }
+  uri::compact_parts result;
+  auto pos = std::size_t{0};
+  auto const length = in.length ();
+  if (auto const colon = find_delimiter<':', '/', '?', '#'> (in, 0); colon < length && colon > 0 && in[colon] == ':') {
+    result.scheme = make_range (0, colon);
+    pos = colon + 1;
+  } else if (!reference) {
+    return std::nullopt;
+  }
+  if (in.substr (pos).starts_with ("//")) {
+    pos += 2;
+    auto const auth_end = find_delimiter<'/', '?', '#'> (in, pos);
+    authority_bounds (in, pos, auth_end, result);
+    pos = auth_end;
+  }
+  auto const path_end = find_delimiter<'?', '#'> (in, pos);
+  if (pos < path_end) {
+    if (in[pos] == '/') {
+      result.absolute = true;
+      ++pos;
+    }
+    result.path = make_range (pos, path_end);
+  }
+  pos = path_end;
+  if (pos < length && in[pos] == '?') {
+    auto const query_end = find_delimiter<'#'> (in, pos);
+    result.query = make_range (pos + 1, query_end);
+    pos = query_end;
+  }
+  if (pos < length && in[pos] == '#') {
+    result.fragment = make_range (pos + 1, length);
+  }
+  return result;
+}
+
+/// scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." )
+constexpr bool valid_scheme (std::string_view const str) noexcept {
+  return !str.empty () && uri::ascii::is (str.front (), alpha) &&
+         std::all_of (str.begin (), str.end (), [] (char const c) { return uri::ascii::is (c, scheme); });
+}
+
+}  // end anonymous namespace
+
+namespace uri {
+
+struct parts::path const& lazy_parts::path () const {
+  if (!path_) {
+    auto& result = path_.emplace (path_type{bounds_.absolute, path_type::segments_type{resource_}});
+    if (auto const path = bounds_.path.view (source_)) {
+      details::split_segments (*path, result.segments);
+    }
+  }
+  return *path_;
+}
+
+bool lazy_parts::check (parts_field const field) const {
+  switch (field) {
+  case parts_field::scheme: return !bounds_.scheme.has_value () || valid_scheme (*this->scheme ());
+  case parts_field::userinfo:
+  case parts_field::host:
+  case parts_field::port: {
+    auto const auth = bounds_.authority (source_);
+    struct parts::authority a;
+    return !auth || details::valid_authority (*auth, a);
+  }
+  case parts_field::path:
+    // A relative path without a scheme or authority must not have a colon in
+    // its first segment: path-noscheme. An absolute path is path-absolute and
+    // may. Otherwise the structure found by the boundary scan already satisfies
+    // the remaining rules of RFC 3986 section 3.3.
+    return !bounds_.path.has_value () ||
+           details::valid_path (*bounds_.path.view (source_), reference_ && !bounds_.scheme.has_value () &&
+                                                                  !bounds_.has_authority () && !bounds_.absolute);
+  case parts_field::query: return !bounds_.query.has_value () || ascii::all_of (*this->query (), ascii::query);
+  case parts_field::fragment:
+    return !bounds_.fragment.has_value () || ascii::all_of (*this->fragment (), ascii::query);
+  case parts_field::last:
+  default: return false;
+  }
+}
+
+bool lazy_parts::valid (parts_field const field) const {
+  auto const bit = field_bit (field);
+  if ((checked_ & bit) == 0U) {
+    if (this->check (field)) {
+      valid_ |= bit;
+    }
+    checked_ |= bit;
+  }
+  return (valid_ & bit) != 0U;
+}
+
+bool lazy_parts::valid () const {
+  return this->valid (parts_field::scheme) && this->valid (parts_field::host) && this->valid (parts_field::path) &&
+         this->valid (parts_field::query) && this->valid (parts_field::fragment);
+}
+
+std::optional<parts> lazy_parts::to_parts () const {
+  if (!this->valid ()) {
+    return std::nullopt;
+  }
+  parts result = make_parts (resource_);
+  result.scheme = this->scheme ();
+  if (auto const host = this->host ()) {
+    auto& auth = result.ensure_authority ();
+    auth.userinfo = this->userinfo ();
+    auth.host = *host;
+    auth.port = this->port ();
+  }
+  result.path = this->path ();
+  result.query = this->query ();
+  result.fragment = this->fragment ();
+  return result;
+}
+
+std::optional<lazy_parts> split_lazy (std::string_view const in, std::pmr::memory_resource* const resource) {
+  if (auto const bounds = boundaries (in, false)) {
+    return lazy_parts{in, *bounds, false, resource};
+  }
+  return std::nullopt;
+}
+
+std::optional<lazy_parts> split_reference_lazy (std::string_view const in,
+                                                std::pmr::memory_resource* const resource) {
+  if (auto const bounds = boundaries (in, true)) {
+    return lazy_parts{in, *bounds, true, resource};
+  }
+  return std::nullopt;
+}
+
+}  // end namespace uri
@@ -0,0 +1,63 @@
+//===- lib/uri/observer.cpp -----------------------------------------------===//
+//*        _                                   *
+//*   ___ | |__  ___  ___ _ ____   _____ _ __  *
+//*  / _ \| '_ \/ __|/ _ \ '__\ \ / / _ \ '__| *
+//* | (_) | |_) \__ \  __/ |   \ V /  __/ |    *
+//*  \___/|_.__/|___/\___|_|    \_/ \___|_|    *
+//*                                            *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/observer.hpp"
+
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+thread_local uri::production_observer* current_observer = nullptr;
+
+}  // end anonymous namespace
+
+namespace uri {
+
+production_observer::~production_observer () noexcept = default;
+
+production_observer* set_production_observer (production_observer* const observer) noexcept {
+  auto* const prev = current_observer;
+  current_observer = observer;
+  return prev;
+}
+
+production_observer* details::get_production_observer () noexcept {
+  return current_observer;
+}
+
+void production_counters::evaluated (std::string_view const name, bool const success, std::size_t const length) {
+  auto pos = stats_.find (name);
+  if (pos == stats_.end ()) {
+    pos = stats_.emplace (std::string{name}, production_stats{}).first;
+  }
+  auto& s = pos->second;
+  ++s.invocations;
+  if (success) {
+    ++s.successes;
+    s.bytes += length;
+  } else {
+    ++s.backtracks;
+  }
+}
+
+std::ostream& operator<< (std::ostream& os, production_counters const& counters) {
+  os << std::left << std::setw (16) << "production" << std::right << std::setw (14) << "invocations" << std::setw (14)
+     << "successes" << std::setw (14) << "backtracks" << std::setw (14) << "bytes" << '\n';
+  for (auto const& [name, s] : counters.stats ()) {
+    os << std::left << std::setw (16) << name << std::right << std::setw (14) << s.invocations << std::setw (14)
+       << s.successes << std::setw (14) << s.backtracks << std::setw (14) << s.bytes << '\n';
+  }
+  return os;
+}
+
+}  // end namespace uri
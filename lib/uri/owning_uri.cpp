@@ -0,0 +1,235 @@
+//===- lib/uri/owning_uri.cpp ---------------------------------------------===//
+//*                      _                          _  *
+//*   _____      ___ __ (_)_ __   __ _   _   _ _ __(_) *
+//*  / _ \ \ /\ / / '_ \| | '_ \ / _` | | | | | '__| | *
+//* | (_) \ V  V /| | | | | | | | (_| | | |_| | |  | | *
+//*  \___/ \_/\_/ |_| |_|_|_| |_|\__, |  \__,_|_|  |_| *
+//*                              |___/                 *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/owning_uri.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#include "uri/ascii.hpp"
+#include "uri/lazy_parts.hpp"
+
+namespace uri {
+
+/// The text of a URI and the boundaries of its components. The characters
+/// follow the rep object in the same allocation. A rep is never modified once
+/// constructed so that it may be shared by any number of owning_uri instances.
+struct owning_uri::rep {
+  std::atomic<std::size_t> refs;
+  compact_parts bounds;
+  std::uint32_t length;
+
+  [[nodiscard]] char* text () noexcept { return reinterpret_cast<char*> (this + 1); }
+  [[nodiscard]] std::string_view str () noexcept { return {this->text (), length}; }
+
+  /// Allocates a rep with room for \p length characters.
+  static rep* allocate (std::size_t const length, compact_parts const& bounds) {
+    void* const p = ::operator new (sizeof (rep) + length);
+    return new (p) rep{1, bounds, static_cast<std::uint32_t> (length)};
+  }
+  static void release (rep* const r) noexcept {
+    if (r != nullptr && r->refs.fetch_sub (1, std::memory_order_acq_rel) == 1) {
+      r->~rep ();
+      ::operator delete (r);
+    }
+  }
+};
+
+namespace {
+
+using range = compact_parts::range;
+
+using details::compact_parts_members;
+
+/// Returns the boundaries that result from replacing the characters [first,
+/// last) with \p length characters. Components which follow the replaced text
+/// are moved. An empty component at \p first precedes the new text.
+compact_parts shift (compact_parts bounds, std::size_t const first, std::size_t const last,
+                     std::size_t const length) noexcept {
+  for (auto const member : compact_parts_members) {
+    auto& r = bounds.*member;
+    if (r.has_value () && (r.offset > first || (r.offset == first && r.length > 0))) {
+      r.offset = static_cast<std::uint32_t> (r.offset - (last - first) + length);
+    }
+  }
+  return bounds;
+}
+
+/// Returns true if the authority whose boundaries are given by \p bounds is
+/// valid and its host is exactly the range recorded in \p bounds.
+bool authority_matches (std::string_view const text, compact_parts const& bounds) {
+  auto const auth = bounds.authority (text);
+  struct parts::authority a;
+  if (!auth || !details::valid_authority (*auth, a)) {
+    return false;
+  }
+  // A host which contains a delimiter would change the structure of the
+  // authority.
+  auto const host = *bounds.host.view (text);
+  return a.host.data () == host.data () && a.host.length () == host.length ();
+}
+
+}  // end anonymous namespace
+
+owning_uri::owning_uri (owning_uri const& other) noexcept : rep_{other.rep_} {
+  if (rep_ != nullptr) {
+    rep_->refs.fetch_add (1, std::memory_order_relaxed);
+  }
+}
+owning_uri::~owning_uri () noexcept {
+  rep::release (rep_);
+}
+owning_uri& owning_uri::operator= (owning_uri const& other) noexcept {
+  if (other.rep_ != nullptr) {
+    other.rep_->refs.fetch_add (1, std::memory_order_relaxed);
+  }
+  rep::release (rep_);
+  rep_ = other.rep_;
+  return *this;
+}
+owning_uri& owning_uri::operator= (owning_uri&& other) noexcept {
+  if (this != &other) {
+    rep::release (rep_);
+    rep_ = other.rep_;
+    other.rep_ = nullptr;
+  }
+  return *this;
+}
+
+std::optional<owning_uri> owning_uri::make (std::string_view const in, std::optional<lazy_parts> const& p) {
+  if (!p || !p->valid ()) {
+    return std::nullopt;
+  }
+  auto* const r = rep::allocate (in.length (), p->bounds ());
+  std::memcpy (r->text (), in.data (), in.length ());
+  return owning_uri{r};
+}
+std::optional<owning_uri> owning_uri::parse (std::string_view const in) {
+  return make (in, split_lazy (in));
+}
+std::optional<owning_uri> owning_uri::parse_reference (std::string_view const in) {
+  return make (in, split_reference_lazy (in));
+}
+
+std::string_view owning_uri::str () const noexcept {
+  return rep_ != nullptr ? rep_->str () : std::string_view{};
+}
+compact_parts const& owning_uri::bounds () const noexcept {
+  static constexpr compact_parts empty;
+  return rep_ != nullptr ? rep_->bounds : empty;
+}
+
+std::string_view owning_uri::path () const noexcept {
+  auto const& b = this->bounds ();
+  if (!b.path.has_value ()) {
+    return {};
+  }
+  auto const first = b.path.offset - (b.absolute ? 1U : 0U);
+  return this->str ().substr (first, b.path.offset + b.path.length - first);
+}
+
+parts owning_uri::to_parts (std::pmr::memory_resource* const resource) const {
+  return expand (this->bounds (), this->str (), resource);
+}
+
+bool owning_uri::replace (std::size_t const first, std::size_t const last,
+                          std::initializer_list<std::string_view> const text, compact_parts const& bounds) {
+  auto const old = this->str ();
+  auto length = std::size_t{0};
+  for (auto const s : text) {
+    length += s.length ();
+  }
+  auto const new_length = old.length () - (last - first) + length;
+  if (new_length >= range::absent) {
+    return false;
+  }
+  auto* const r = rep::allocate (new_length, bounds);
+  auto* out = std::copy_n (old.data (), first, r->text ());
+  for (auto const s : text) {
+    out = std::copy (s.begin (), s.end (), out);
+  }
+  std::copy (old.begin () + static_cast<std::ptrdiff_t> (last), old.end (), out);
+  rep::release (rep_);
+  rep_ = r;
+  return true;
+}
+
+bool owning_uri::set_host (std::string_view const host) {
+  auto const& b = this->bounds ();
+  if (b.has_authority ()) {
+    auto const first = std::size_t{b.host.offset};
+    auto const last = first + b.host.length;
+    auto bounds = shift (b, first, last, host.length ());
+    bounds.host = range{b.host.offset, static_cast<std::uint32_t> (host.length ())};
+    return this->replace_checked (first, last, {host}, bounds);
+  }
+  // The path following an authority must be empty or begin with "/".
+  if (b.path.has_value () && !b.absolute) {
+    return false;
+  }
+  auto const pos = b.scheme.has_value () ? std::size_t{b.scheme.offset} + b.scheme.length + 1 : std::size_t{0};
+  auto bounds = shift (b, pos, pos, host.length () + 2);
+  bounds.host = range{static_cast<std::uint32_t> (pos + 2), static_cast<std::uint32_t> (host.length ())};
+  return this->replace_checked (pos, pos, {"//", host}, bounds);
+}
+
+bool owning_uri::set_query (std::optional<std::string_view> const query) {
+  auto const& b = this->bounds ();
+  // The query precedes the fragment.
+  auto const pos = b.fragment.has_value () ? std::size_t{b.fragment.offset} - 1U : this->str ().length ();
+  return this->set_query_or_fragment (&compact_parts::query, '?', pos, query);
+}
+bool owning_uri::set_fragment (std::optional<std::string_view> const fragment) {
+  return this->set_query_or_fragment (&compact_parts::fragment, '#', this->str ().length (), fragment);
+}
+
+bool owning_uri::set_query_or_fragment (range compact_parts::* const member, char const delimiter,
+                                        std::size_t const pos, std::optional<std::string_view> const value) {
+  // query         = *( pchar / "/" / "?" )
+  // fragment      = *( pchar / "/" / "?" )
+  if (value && !ascii::all_of (*value, ascii::query)) {
+    return false;
+  }
+  auto const& b = this->bounds ();
+  auto const& current = b.*member;
+  // The text to be replaced includes the delimiter.
+  auto const first = current.has_value () ? std::size_t{current.offset} - 1U : pos;
+  auto const last = current.has_value () ? std::size_t{current.offset} + current.length : pos;
+  if (!value) {
+    if (!current.has_value ()) {
+      return true;
+    }
+    auto bounds = shift (b, first, last, 0);
+    bounds.*member = range{};
+    return this->replace (first, last, {}, bounds);
+  }
+  auto bounds = shift (b, first, last, value->length () + 1);
+  bounds.*member = range{static_cast<std::uint32_t> (first + 1), static_cast<std::uint32_t> (value->length ())};
+  auto const delim = std::string_view{&delimiter, 1};
+  return this->replace (first, last, {delim, *value}, bounds);
+}
+
+bool owning_uri::replace_checked (std::size_t const first, std::size_t const last,
+                                  std::initializer_list<std::string_view> const text, compact_parts const& bounds) {
+  auto previous = *this;
+  if (!this->replace (first, last, text, bounds)) {
+    return false;
+  }
+  if (!authority_matches (this->str (), bounds)) {
+    *this = std::move (previous);
+    return false;
+  }
+  return true;
+}
+
+}  // end namespace uri
@@ -40,3 +40,17 @@ std::size_t pct_decoded_size (std::string_view const str) {
 }
 
 }  // end namespace uri::details
+
+namespace uri {
+
+void relocate (parts& p, std::string_view const from, std::string_view const to) {
+  assert (to.length () >= from.length ());
+  details::parts_strings (p, [&] (std::string_view const str, unsigned, parts_field) {
+    if (!details::within (from, str)) {
+      return str;
+    }
+    return std::string_view{to.data () + (str.data () - from.data ()), str.length ()};
+  });
+}
+
+}  // end namespace uri
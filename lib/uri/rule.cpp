@@ -14,44 +14,37 @@
 
 #include <algorithm>
 #include <cassert>
-#include <iomanip>
-#include <iostream>
 #include <iterator>
 
+#include "uri/observer.hpp"
+
 namespace uri {
 
+void acceptor_log::run (marker const last) const {
+  assert (last <= entries_.size ());
+  std::for_each (std::begin (entries_), std::begin (entries_) + static_cast<std::ptrdiff_t> (last),
+                 [] (value_type const& a) { a.accept (a.str); });
+}
+
 bool rule::done () const {
   if (!tail_ || !tail_->empty ()) {
     return false;
   }
   // Run all of the acceptor functions that were gathered on the grammar path
   // that we matched.
-  std::for_each (std::begin (acceptors_), std::end (acceptors_),
-                 [] (acceptor_container::value_type const& a) {
-                   std::invoke (std::get<0> (a), std::get<1> (a));
-                 });
+  assert (log_ != nullptr);
+  log_->run (pos_);
   return true;
 }
 
 rule::matched_result rule::matched (char const* name, rule const& in) const {
   assert (!tail_ || in.tail_);
-  static constexpr auto trace = false;
-  if constexpr (trace) {
-    std::cout << (tail_ ? '*' : '-') << ' ' << std::quoted (name);
-  }
-
   if (tail_) {
-    std::string_view const str =
-      in.tail_->substr (0, in.tail_->length () - tail_->length ());
-    if constexpr (trace) {
-      std::cout << ' ' << std::quoted (str) << '\n';
-    }
-    return std::make_tuple (str, acceptors_);
-  }
-
-  if constexpr (trace) {
-    std::cout << '\n';
+    std::string_view const str = in.tail_->substr (0, in.tail_->length () - tail_->length ());
+    details::production_evaluated (name, true, str.length ());
+    return std::make_tuple (str, pos_);
   }
+  details::production_evaluated (name, false, 0);
   return {};
 }
 
@@ -0,0 +1,373 @@
+//===- lib/uri/scanner.cpp ------------------------------------------------===//
+//*                                       *
+//*  ___  ___ __ _ _ __  _ __   ___ _ __  *
+//* / __|/ __/ _` | '_ \| '_ \ / _ \ '__| *
+//* \__ \ (_| (_| | | | | | | |  __/ |    *
+//* |___/\___\__,_|_| |_|_| |_|\___|_|    *
+//*                                       *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <cassert>
+
+#include "uri/ascii.hpp"
+#include "uri/uri.hpp"
+
+// This file contains a single-pass recognizer for the URI and URI-reference
+// productions of RFC 3986. It finds component boundaries by classifying each
+// input character with a table lookup rather than by evaluating the grammar in
+// uri.cpp.
+//
+// The results must be identical to those produced by the grammar including
+// its (ordered choice) treatment of ambiguous input. The one exception is that
+// authorities containing an IP-literal are not handled here: those cases are
+// reported with scan_result::fallback so that the caller can use the grammar
+// instead.
+
+namespace {
+
+using uri::ascii::all_of;
+using uri::ascii::is;
+using uri::ascii::is_pct_encoded;
+using enum uri::ascii::char_class;
+
+constexpr auto npos = std::string_view::npos;
+
+/// Returns the length of the scheme at the start of \p in or 0 if there is no
+/// scheme.
+///
+/// scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." )
+constexpr std::size_t scheme_length (std::string_view const in) noexcept {
+  if (in.empty () || !is (in.front (), alpha)) {
+    return 0;
+  }
+  auto pos = std::size_t{1};
+  while (pos < in.length () && is (in[pos], scheme)) {
+    ++pos;
+  }
+  return pos;
+}
+
+/// Returns the length of the dec-octet at the start of \p str or 0 if there
+/// isn't one. The alternatives are tried in the same order as the grammar.
+///
+/// dec-octet     = "25" %x30-35          ; 250-255
+///               / "2" %x30-34 DIGIT     ; 200-249
+///               / "1" 2DIGIT            ; 100-199
+///               / %x31-39 DIGIT         ; 10-99
+///               / DIGIT                 ; 0-9
+constexpr std::size_t dec_octet_length (std::string_view const str) noexcept {
+  auto const at = [&str] (std::size_t const pos) { return pos < str.length () ? str[pos] : '\0'; };
+  auto const in_range = [] (char const c, char const first, char const last) { return c >= first && c <= last; };
+  if (at (0) == '2' && at (1) == '5' && in_range (at (2), '0', '5')) {
+    return 3;
+  }
+  if (at (0) == '2' && in_range (at (1), '0', '4') && is (at (2), digit)) {
+    return 3;
+  }
+  if (at (0) == '1' && is (at (1), digit) && is (at (2), digit)) {
+    return 3;
+  }
+  if (in_range (at (0), '1', '9') && is (at (1), digit)) {
+    return 2;
+  }
+  return is (at (0), digit) ? 1 : 0;
+}
+
+/// Returns the length of the IPv4address at the start of \p str or 0 if there
+/// isn't one.
+///
+/// IPv4address   = dec-octet "." dec-octet "." dec-octet "." dec-octet
+constexpr std::size_t ipv4address_length (std::string_view const str) noexcept {
+  auto pos = std::size_t{0};
+  for (auto octet = 0U; octet < 4U; ++octet) {
+    if (octet > 0U) {
+      if (pos >= str.length () || str[pos] != '.') {
+        return 0;
+      }
+      ++pos;
+    }
+    auto const length = dec_octet_length (str.substr (pos));
+    if (length == 0) {
+      return 0;
+    }
+    pos += length;
+  }
+  return pos;
+}
+
+/// authority     = [ userinfo "@" ] host [ ":" port ]
+///
+/// \p auth is the text between "//" and the next "/", "?", "#" or the end of
+///   the input. It must not contain an IP-literal.
+bool authority (std::string_view const auth, struct uri::parts::authority& authority) {
+  uri::details::delimit_authority (auth, authority);
+  if (authority.userinfo && !all_of (*authority.userinfo, userinfo)) {
+    return false;
+  }
+  auto const host = authority.host;
+  if (!all_of (host, reg_name)) {
+    return false;
+  }
+  // The grammar tries IPv4address before reg-name. If an IPv4address matches
+  // only part of the host, the remaining characters can't be matched by
+  // anything that follows it.
+  if (auto const ipv4_length = ipv4address_length (host); ipv4_length != 0 && ipv4_length != host.length ()) {
+    return false;
+  }
+  // port          = *DIGIT
+  return !authority.port || std::all_of (authority.port->begin (), authority.port->end (),
+                                         [] (char const c) { return is (c, digit); });
+}
+
+/// Splits the path which begins at \p pos and ends at the first "?", "#" or
+/// the end of \p in into segments. Each of the segments is appended to \p
+/// result.path.
+///
+/// \param in  The input string.
+/// \param pos  The position of the first character of the first segment.
+/// \param no_colon  If true, the first segment must not contain a colon.
+/// \param result  The parts object whose path is to be updated.
+/// \returns The position of the end of the path or npos if the path contains
+///   characters which are not permitted.
+std::size_t segments (std::string_view const in, std::size_t const pos, bool const no_colon, uri::parts& result) {
+  auto const end = std::min (in.find_first_of ("?#", pos), in.length ());
+  auto const path = in.substr (pos, end - pos);
+  if (!uri::details::valid_path (path, no_colon)) {
+    return npos;
+  }
+  uri::details::split_segments (path, result.path.segments);
+  return end;
+}
+
+}  // end anonymous namespace
+
+namespace uri::details {
+
+void delimit_authority (std::string_view const auth, struct parts::authority& result) noexcept {
+  auto host_port = auth;
+  if (auto const at = auth.find ('@'); at != npos) {
+    // The userinfo production can't contain "@" so the first instance must be
+    // the delimiter.
+    result.userinfo = auth.substr (0, at);
+    host_port.remove_prefix (at + 1);
+  }
+  // reg-name doesn't include ":" so the first instance delimits the host. An
+  // IP-literal may contain colons so the search starts after its closing "]".
+  auto port_search = std::size_t{0};
+  if (host_port.starts_with ('[')) {
+    // IP-literal = "[" ( IPv6address / IPvFuture  ) "]"
+    port_search = std::min (host_port.find (']'), host_port.length ());
+  }
+  auto const colon = host_port.find (':', port_search);
+  result.host = host_port.substr (0, colon);
+  if (colon != npos) {
+    result.port = host_port.substr (colon + 1);
+  }
+}
+
+bool valid_path (std::string_view const path, bool no_colon) noexcept {
+  for (auto pos = std::size_t{0}; pos < path.length ();) {
+    if (path[pos] == '/') {
+      no_colon = false;
+      ++pos;
+    } else if (is (path[pos], pchar)) {
+      if (no_colon && path[pos] == ':') {
+        return false;
+      }
+      ++pos;
+    } else if (is_pct_encoded (path, pos)) {
+      pos += 3;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+void split_segments (std::string_view path, parts::path::segments_type& segments) {
+  for (;;) {
+    auto const slash = path.find ('/');
+    segments.emplace_back (path.substr (0, slash));
+    if (slash == npos) {
+      break;
+    }
+    path.remove_prefix (slash + 1);
+  }
+}
+
+scan_result scan_authority (std::string_view const auth, struct parts::authority& result) {
+  if (auth.find ('[') != npos) {
+    return scan_result::fallback;
+  }
+  return authority (auth, result) ? scan_result::success : scan_result::failure;
+}
+
+// URI           = scheme ":" hier-part [ "?" query ] [ "#" fragment ]
+// URI-reference = URI / relative-ref
+// relative-ref  = relative-part [ "?" query ] [ "#" fragment ]
+//
+// hier-part     = "//" authority path-abempty
+//               / path-absolute
+//               / path-rootless
+//               / path-empty
+//
+// relative-part = "//" authority path-abempty
+//               / path-absolute
+//               / path-noscheme
+//               / path-empty
+scan_result scan (std::string_view const in, bool const reference, parts& result) {
+  auto pos = std::size_t{0};
+  auto const length = in.length ();
+
+  // Once "scheme:" has been matched the URI alternative is committed: the
+  // relative-ref alternative is tried only if it was not.
+  bool const is_uri = [&] {
+    if (auto const sl = scheme_length (in); sl > 0 && sl < length && in[sl] == ':') {
+      result.scheme = in.substr (0, sl);
+      pos = sl + 1;
+      return true;
+    }
+    return false;
+  }();
+  if (!is_uri && !reference) {
+    return scan_result::failure;
+  }
+
+  auto const rest = in.substr (pos);
+  if (rest.starts_with ("//")) {
+    // "//" authority path-abempty
+    pos += 2;
+    auto const auth_end = std::min (in.find_first_of ("/?#", pos), length);
+    auto const auth = in.substr (pos, auth_end - pos);
+    if (auto const r = scan_authority (auth, result.ensure_authority ()); r != scan_result::success) {
+      return r;
+    }
+    pos = auth_end;
+    if (pos < length && in[pos] == '/') {
+      result.path.absolute = true;
+      pos = segments (in, pos + 1, false, result);
+    }
+  } else if (rest.starts_with ('/')) {
+    // path-absolute = "/" [ segment-nz *( "/" segment ) ]
+    result.path.absolute = true;
+    pos = segments (in, pos + 1, false, result);
+  } else if (pos < length && in[pos] != '?' && in[pos] != '#') {
+    // path-rootless = segment-nz *( "/" segment )
+    // path-noscheme = segment-nz-nc *( "/" segment )
+    pos = segments (in, pos, !is_uri, result);
+  }
+  if (pos == npos) {
+    return scan_result::failure;
+  }
+
+  if (pos < length && in[pos] == '?') {
+    // query         = *( pchar / "/" / "?" )
+    ++pos;
+    auto const query_end = std::min (in.find ('#', pos), length);
+    auto const q = in.substr (pos, query_end - pos);
+    if (!all_of (q, query)) {
+      return scan_result::failure;
+    }
+    result.query = q;
+    pos = query_end;
+  }
+  if (pos < length && in[pos] == '#') {
+    // fragment      = *( pchar / "/" / "?" )
+    ++pos;
+    auto const f = in.substr (pos);
+    if (!all_of (f, query)) {
+      return scan_result::failure;
+    }
+    result.fragment = f;
+    pos = length;
+  }
+  return pos == length ? scan_result::success : scan_result::failure;
+}
+
+scan_result scan_fields (std::string_view const in, bool const reference, field_mask const fields, parts& result) {
+  auto pos = std::size_t{0};
+  auto const length = in.length ();
+
+  bool const is_uri = [&] {
+    if (auto const sl = scheme_length (in); sl > 0 && sl < length && in[sl] == ':') {
+      if (includes (fields, field_mask::scheme)) {
+        result.scheme = in.substr (0, sl);
+      }
+      pos = sl + 1;
+      return true;
+    }
+    return false;
+  }();
+  if (!is_uri && !reference) {
+    return scan_result::failure;
+  }
+
+  if (in.substr (pos).starts_with ("//")) {
+    pos += 2;
+    auto const auth_end = std::min (in.find_first_of ("/?#", pos), length);
+    if (includes (fields, field_mask::authority)) {
+      struct parts::authority auth;
+      if (!valid_authority (in.substr (pos, auth_end - pos), auth)) {
+        return scan_result::failure;
+      }
+      auto& authority = result.ensure_authority ();
+      if (includes (fields, field_mask::userinfo)) {
+        authority.userinfo = auth.userinfo;
+      }
+      if (includes (fields, field_mask::host)) {
+        authority.host = auth.host;
+      }
+      if (includes (fields, field_mask::port)) {
+        authority.port = auth.port;
+      }
+    }
+    pos = auth_end;
+  }
+
+  if (includes (fields, field_mask::path)) {
+    if (pos < length && in[pos] == '/') {
+      result.path.absolute = true;
+      pos = segments (in, pos + 1, false, result);
+    } else if (pos < length && in[pos] != '?' && in[pos] != '#') {
+      pos = segments (in, pos, !is_uri, result);
+    }
+    if (pos == npos) {
+      return scan_result::failure;
+    }
+  } else if (includes (fields, field_mask::query)) {
+    pos = std::min (in.find_first_of ("?#", pos), length);
+  } else if (includes (fields, field_mask::fragment)) {
+    // Only the fragment is needed. The first "#" in the input delimits it.
+    pos = std::min (in.find ('#', pos), length);
+  }
+  if (!includes (fields, field_mask::query | field_mask::fragment)) {
+    return scan_result::success;
+  }
+
+  if (pos < length && in[pos] == '?') {
+    ++pos;
+    auto const query_end = std::min (in.find ('#', pos), length);
+    if (includes (fields, field_mask::query)) {
+      auto const q = in.substr (pos, query_end - pos);
+      if (!all_of (q, query)) {
+        return scan_result::failure;
+      }
+      result.query = q;
+    }
+    pos = query_end;
+  }
+  if (pos < length && in[pos] == '#' && includes (fields, field_mask::fragment)) {
+    auto const f = in.substr (pos + 1);
+    if (!all_of (f, query)) {
+      return scan_result::failure;
+    }
+    result.fragment = f;
+  }
+  return scan_result::success;
+}
+
+}  // end namespace uri::details
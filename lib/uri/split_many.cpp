@@ -0,0 +1,108 @@
+//===- lib/uri/split_many.cpp ---------------------------------------------===//
+//*            _ _ _                                  *
+//*  ___ _ __ | (_) |_   _ __ ___   __ _ _ __  _   _  *
+//* / __| '_ \| | | __| | '_ ` _ \ / _` | '_ \| | | | *
+//* \__ \ |_) | | | |_  | | | | | | (_| | | | | |_| | *
+//* |___/ .__/|_|_|\__| |_| |_| |_|\__,_|_| |_|\__, | *
+//*     |_|                                    |___/  *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "uri/split_many.hpp"
+
+#include <array>
+#include <cassert>
+
+namespace {
+
+template <bool Reference>
+void split_all (std::span<std::string_view const> const inputs, uri::split_columns& out) {
+  out.clear ();
+  out.reserve (inputs.size ());
+  // Any memory needed for the path segments of an individual input comes from
+  // this arena. It is reset after each input.
+  std::array<std::byte, 1024> buffer;
+  std::pmr::monotonic_buffer_resource arena{buffer.data (), buffer.size ()};
+  for (auto const in : inputs) {
+    {
+      auto const p = Reference ? uri::split_reference (in, &arena) : uri::split (in, &arena);
+      out.push_back (p ? uri::compact (*p, in) : std::nullopt);
+    }
+    arena.release ();
+  }
+}
+
+}  // end anonymous namespace
+
+namespace uri {
+
+compact_parts split_columns::compact_row (std::size_t const row) const noexcept {
+  assert (row < this->size ());
+  compact_parts result;
+  result.scheme = scheme[row];
+  result.userinfo = userinfo[row];
+  result.host = host[row];
+  result.port = port[row];
+  result.path = path[row];
+  result.query = query[row];
+  result.fragment = fragment[row];
+  result.absolute = this->absolute (row);
+  return result;
+}
+
+std::optional<parts> split_columns::row (std::size_t const row, std::string_view const source) const {
+  if (!this->valid (row)) {
+    return std::nullopt;
+  }
+  return expand (this->compact_row (row), source);
+}
+
+void split_columns::clear () noexcept {
+  for (auto* const c : {&scheme, &userinfo, &host, &port, &path, &query, &fragment}) {
+    c->clear ();
+  }
+  valid_bits.clear ();
+  absolute_bits.clear ();
+}
+
+void split_columns::reserve (std::size_t const rows) {
+  for (auto* const c : {&scheme, &userinfo, &host, &port, &path, &query, &fragment}) {
+    c->reserve (rows);
+  }
+  valid_bits.reserve ((rows + 63U) / 64U);
+  absolute_bits.reserve ((rows + 63U) / 64U);
+}
+
+void split_columns::push_back (std::optional<compact_parts> const& c) {
+  auto const row = this->size ();
+  if (row % 64U == 0) {
+    valid_bits.push_back (0);
+    absolute_bits.push_back (0);
+  }
+  auto const bit = std::uint64_t{1} << (row % 64U);
+  compact_parts const value = c.value_or (compact_parts{});
+  scheme.push_back (value.scheme);
+  userinfo.push_back (value.userinfo);
+  host.push_back (value.host);
+  port.push_back (value.port);
+  path.push_back (value.path);
+  query.push_back (value.query);
+  fragment.push_back (value.fragment);
+  if (c) {
+    valid_bits.back () |= bit;
+  }
+  if (value.absolute) {
+    absolute_bits.back () |= bit;
+  }
+}
+
+void split_many (std::span<std::string_view const> const inputs, split_columns& out) {
+  split_all<false> (inputs, out);
+}
+void split_reference_many (std::span<std::string_view const> const inputs, split_columns& out) {
+  split_all<true> (inputs, out);
+}
+
+}  // end namespace uri
@@ -13,248 +13,136 @@
 #include "uri/uri.hpp"
 
 #include <cassert>
-#include <sstream>
+#include <functional>
+#include <iterator>
+#include <ostream>
 
+#include "grammar.hpp"
+#include "uri/ascii.hpp"
 #include "uri/pctencode.hpp"
-#include "uri/rule.hpp"
 
 using namespace uri;
 
 namespace {
 
-inline auto single_code_point (rule const& r, code_point const cp) {
-  assert (static_cast<std::underlying_type_t<code_point>> (cp) <=
-          static_cast<std::underlying_type_t<code_point>> (
-            std::numeric_limits<char>::max ()));
-  return r.single_char (static_cast<char> (cp));
+// Acceptor functions
+// ~~~~~~~~~~~~~~~~~~
+void set_scheme (uri::parts& result, std::string_view const scheme) {
+  result.scheme = scheme;
 }
-
-inline auto code_point_range (code_point const first, code_point const last) {
-  assert (static_cast<std::underlying_type_t<code_point>> (first) <=
-          static_cast<std::underlying_type_t<code_point>> (
-            std::numeric_limits<char>::max ()));
-  assert (static_cast<std::underlying_type_t<code_point>> (last) <=
-          static_cast<std::underlying_type_t<code_point>> (
-            std::numeric_limits<char>::max ()));
-  return [f = std::tolower (static_cast<int> (first)),
-          l = std::tolower (static_cast<int> (last))] (rule const& r) {
-    return r.single_char ([=] (char const c) {
-      auto const cl = std::tolower (static_cast<int> (c));
-      return cl >= f && cl <= l;
-    });
-  };
-}
-
-inline auto commercial_at (rule const& r) {
-  return single_code_point (r, code_point::commercial_at);
-}
-inline auto colon (rule const& r) {
-  return single_code_point (r, code_point::colon);
-}
-inline auto hash (rule const& r) {
-  return single_code_point (r, code_point::number_sign);
+void set_userinfo (uri::parts& result, std::string_view const userinfo) {
+  result.ensure_authority ().userinfo = userinfo;
 }
-inline auto plus (rule const& r) {
-  return single_code_point (r, code_point::plus_sign);
+void set_host (uri::parts& result, std::string_view const host) {
+  result.ensure_authority ().host = host;
 }
-inline auto minus (rule const& r) {
-  return single_code_point (r, code_point::hyphen_minus);
+void set_port (uri::parts& result, std::string_view const port) {
+  result.ensure_authority ().port = port;
 }
-inline auto solidus (rule const& r) {
-  return single_code_point (r, code_point::solidus);
+void set_query (uri::parts& result, std::string_view const query) {
+  result.query = query;
 }
-inline auto question_mark (rule const& r) {
-  return single_code_point (r, code_point::question_mark);
+void set_fragment (uri::parts& result, std::string_view const fragment) {
+  result.fragment = fragment;
 }
-inline auto full_stop (rule const& r) {
-  return single_code_point (r, code_point::full_stop);
-}
-inline auto left_square_bracket (rule const& r) {
-  return single_code_point (r, code_point::left_square_bracket);
-}
-inline auto right_square_bracket (rule const& r) {
-  return single_code_point (r, code_point::right_square_bracket);
-}
-inline auto percent_sign (rule const& r) {
-  return single_code_point (r, code_point::percent_sign);
-}
-inline auto digit_one (rule const& r) {
-  return single_code_point (r, code_point::digit_one);
-}
-inline auto digit_two (rule const& r) {
-  return single_code_point (r, code_point::digit_two);
+
+template <bool IsAbs>
+void append_dir (uri::parts& result, std::string_view const str) {
+  (void)str;
+  if constexpr (IsAbs) {
+    result.path.absolute = true;
+  }
+  result.path.segments.emplace_back ();
 }
-inline auto digit_five (rule const& r) {
-  return single_code_point (r, code_point::digit_five);
+void append_segment (uri::parts& result, std::string_view const seg) {
+  assert (!result.path.segments.empty ());
+  result.path.segments.back () = seg;
 }
-inline auto latin_small_letter_v (rule const& r) {
-  return single_code_point (r, code_point::latin_small_letter_v);
+void record_initial_segment (uri::parts& result, std::string_view const seg) {
+  result.path.segments.emplace_back (seg);
 }
 
-auto single_colon (rule const& r) {
-  return r.concat (colon)
-    .concat ([] (rule const& r1) -> rule::matched_result {
-      if (auto const& sv = r1.tail ()) {
-        if (sv->empty () || sv->front () != ':') {
-          return std::make_tuple (sv->substr (0, 0),
-                                  rule::acceptor_container{});
-        }
-      }
-      return {};
-    })
-    .matched ("single-colon", r);
-}
+namespace rfc3986 {
+
+using namespace uri::grammar;
+
+template <code_point CP>
+using code_point_char = single_char<static_cast<char> (CP)>;
+template <code_point First, code_point Last>
+using code_point_range = char_range<static_cast<char> (First), static_cast<char> (Last)>;
+
+using commercial_at = code_point_char<code_point::commercial_at>;
+using colon = code_point_char<code_point::colon>;
+using hash = code_point_char<code_point::number_sign>;
+using plus = code_point_char<code_point::plus_sign>;
+using minus = code_point_char<code_point::hyphen_minus>;
+using solidus = code_point_char<code_point::solidus>;
+using question_mark = code_point_char<code_point::question_mark>;
+using full_stop = code_point_char<code_point::full_stop>;
+using left_square_bracket = code_point_char<code_point::left_square_bracket>;
+using right_square_bracket = code_point_char<code_point::right_square_bracket>;
+using percent_sign = code_point_char<code_point::percent_sign>;
+using digit_one = code_point_char<code_point::digit_one>;
+using digit_two = code_point_char<code_point::digit_two>;
+using digit_five = code_point_char<code_point::digit_five>;
+using latin_small_letter_v = code_point_char<code_point::latin_small_letter_v>;
+
+using single_colon = concat<colon, not_followed_by<colon>>;
 
 // sub-delims    = "!" / "$" / "&" / "'" / "(" / ")"
 //               / "*" / "+" / "," / ";" / "="
-auto sub_delims (rule const& r) {
-  return r.single_char ([] (char const c) {
-    auto const cp = static_cast<code_point> (c);
-    return cp == code_point::exclamation_mark ||
-           cp == code_point::dollar_sign || cp == code_point::ampersand ||
-           cp == code_point::apostrophe || cp == code_point::left_parenthesis ||
-           cp == code_point::right_parenthesis || cp == code_point::asterisk ||
-           cp == code_point::plus_sign || cp == code_point::comma ||
-           cp == code_point::semi_colon || cp == code_point::equals_sign;
-  });
-}
+using sub_delims = char_if<&ascii::is_sub_delim>;
 
 // unreserved    = ALPHA / DIGIT / "-" / "." / "_" / "~"
-auto unreserved (rule const& r) {
-  return r.single_char ([] (char const c) {
-    auto const cp = static_cast<code_point> (c);
-    return static_cast<bool> (std::isalnum (static_cast<int> (c))) ||
-           cp == code_point::hyphen_minus || cp == code_point::full_stop ||
-           cp == code_point::low_line || cp == code_point::tilde;
-  });
-}
+using unreserved = char_if<&ascii::is_unreserved>;
+
+// The single-character members of the pchar, userinfo, reg-name, and query
+// productions (that is, excluding pct-encoded).
+template <ascii::char_class Class>
+using char_class = char_if<[] (char const c) { return ascii::is (c, Class); }>;
 
 // pct-encoded   = "%" HEXDIG HEXDIG
-auto pct_encoded (rule const& r) {
-  return r.concat (percent_sign)
-    .concat (hexdig)
-    .concat (hexdig)
-    .matched ("pct-encoded", r);
-}
+using pct_encoded = named<"pct-encoded", concat<percent_sign, hexdig, hexdig>>;
 
 // pchar         = unreserved / pct-encoded / sub-delims / ":" / "@"
-auto pchar (rule const& r) {
-  return r
-    .alternative (unreserved, pct_encoded, sub_delims, colon, commercial_at)
-    .matched ("pchar", r);
-}
+using pchar = named<"pchar", alternative<char_class<ascii::pchar>, pct_encoded>>;
 
 // userinfo      = *( unreserved / pct-encoded / sub-delims / ":" )
-auto userinfo (rule const& r) {
-  return r
-    .star ([] (rule const& r2) {
-      return r2.alternative (unreserved, pct_encoded, sub_delims, colon)
-        .matched ("userinfo/*", r2);
-    })
-    .matched ("userinfo", r);
-}
-constexpr auto userinfofn = userinfo;
+using userinfo = named<"userinfo", star<alternative<char_class<ascii::userinfo>, pct_encoded>>>;
 
 // scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." )
-auto scheme (rule const& r) {
-  return r.concat (alpha)
-    .star ([] (rule const& r2) {
-      return r2.alternative (alpha, digit, plus, minus, full_stop)
-        .matched ("scheme/*", r2);
-    })
-    .matched ("scheme", r);
-}
-constexpr auto schemefn = scheme;
+using scheme = named<"scheme", concat<alpha, star<alternative<alpha, digit, plus, minus, full_stop>>>>;
 
 // reg-name      = *( unreserved / pct-encoded / sub-delims )
-auto reg_name (rule const& r) {
-  return r
-    .star ([] (rule const& r1) {
-      return r1.alternative (unreserved, pct_encoded, sub_delims)
-        .matched ("reg-name/*", r1);
-    })
-    .matched ("reg-name", r);
-}
+using reg_name = named<"reg-name", star<alternative<char_class<ascii::reg_name>, pct_encoded>>>;
 
 // dec-octet     = DIGIT                 ; 0-9
 //               / %x31-39 DIGIT         ; 10-99
 //               / "1" 2DIGIT            ; 100-199
 //               / "2" %x30-34 DIGIT     ; 200-249
 //               / "25" %x30-35          ; 250-255
-auto dec_octet (rule const& r) {
-  return r
-    .alternative (
-      [] (rule const& r4) {
-        return r4               // 250-255
-          .concat (digit_two)   // "2"
-          .concat (digit_five)  // "5"
-          .concat (code_point_range (code_point::digit_zero,
-                                     code_point::digit_five))  // %x30-35
-          .matched ("\"25\" %x30-35", r4);
-      },
-      [] (rule const& r3) {
-        return r3              // 200-249
-          .concat (digit_two)  // "2"
-          .concat (code_point_range (code_point::digit_zero,
-                                     code_point::digit_four))  // %x30-34
-          .concat (digit)                                      // DIGIT
-          .matched ("\"2\" %x30-34 DIGIT", r3);
-      },
-      [] (rule const& r2) {
-        return r2              // 100-199
-          .concat (digit_one)  // "1"
-          .concat (digit)      // 2DIGIT
-          .concat (digit)      // (...)
-          .matched ("\"1\" 2DIGIT", r2);
-      },
-      [] (rule const& r1) {
-        return r1  // 10-99
-          .concat (code_point_range (code_point::digit_one,
-                                     code_point::digit_nine))  // %x31-39
-          .concat (digit)                                      // DIGIT
-          .matched ("%x31-39 DIGIT", r1);
-      },
-      digit)
-    .matched ("dec-octet", r);
-}
+using dec_octet =
+  named<"dec-octet",
+        alternative<concat<digit_two, digit_five, code_point_range<code_point::digit_zero, code_point::digit_five>>,
+                    concat<digit_two, code_point_range<code_point::digit_zero, code_point::digit_four>, digit>,
+                    concat<digit_one, digit, digit>,
+                    concat<code_point_range<code_point::digit_one, code_point::digit_nine>, digit>, digit>>;
 
 // IPv4address   = dec-octet "." dec-octet "." dec-octet "." dec-octet
-auto ipv4address (rule const& r) {
-  return r
-    .concat (dec_octet)  // dec-octet
-    .concat (full_stop)  // "."
-    .concat (dec_octet)  // dec-octet
-    .concat (full_stop)  // "."
-    .concat (dec_octet)  // dec-octet
-    .concat (full_stop)  // "."
-    .concat (dec_octet)  // dec-octet
-    .matched ("IPv4address", r);
-}
+using ipv4address =
+  named<"IPv4address", concat<dec_octet, full_stop, dec_octet, full_stop, dec_octet, full_stop, dec_octet>>;
 
 // h16 = 1*4HEXDIG
-auto h16 (rule const& r) {
-  return r.star (hexdig, 1, 4).matched ("h16", r);
-}
+using h16 = named<"h16", star<hexdig, 1, 4>>;
 
 // h16colon = h16 ":"
-auto h16_colon (rule const& r) {
-  return r.concat (h16).concat (single_colon).matched ("h16:", r);
-}
-auto colon_colon (rule const& r) {
-  return r.concat (colon).concat (colon).matched ("\"::\"", r);
-}
+// The alternatives of IPv6address each match a run of h16colon from the same
+// starting point so these are memoized.
+using h16_colon = memo<concat<h16, single_colon>>;
+using colon_colon = concat<colon, colon>;
 
 // ls32          = ( h16 ":" h16 ) / IPv4address
-auto ls32 (rule const& r) {
-  return r
-    .alternative (
-      [] (rule const& r1) {
-        return r1.concat (h16).concat (colon).concat (h16).matched ("h16:h16",
-                                                                    r1);
-      },
-      ipv4address)
-    .matched ("ls32", r);
-}
+using ls32 = memo<named<"ls32", alternative<concat<h16, colon, h16>, ipv4address>>>;
 
 // IPv6address =                            6( h16 ":" ) ls32 // r1
 //             /                       "::" 5( h16 ":" ) ls32 // r2
@@ -265,459 +153,114 @@ auto ls32 (rule const& r) {
 //             / [ *4( h16 ":" ) h16 ] "::"              ls32 // r7
 //             / [ *5( h16 ":" ) h16 ] "::"              h16  // r8
 //             / [ *6( h16 ":" ) h16 ] "::"                   // r9
-auto ipv6address (rule const& r) {
-  return r
-    .alternative (
-      [] (rule const& r1) {
-        // 6( h16 ":" ) ls32
-        return r1.star (h16_colon, 6, 6)
-          .concat (ls32)
-          .matched ("6( h16: ) ls32", r1);
-      },
-      [] (rule const& r2) {
-        // "::" 5( h16 ":" ) ls32
-        return r2.concat (colon_colon)
-          .star (h16_colon, 5, 5)
-          .concat (ls32)
-          .matched ("\"::\" 5( h16 colon ) ls32", r2);
-      },
-      [] (rule const& r3) {
-        // [ h16 ] "::" 4( h16 ":" ) ls32
-        return r3.optional (h16)
-          .concat (colon_colon)
-          .star (h16_colon, 4, 4)
-          .concat (ls32)
-          .matched ("[ h16 ] \"::\" 4( h16 colon ) ls32", r3);
-      },
-      [] (rule const& r4) {
-        // [ *1( h16 ":" ) h16 ] "::" 3( h16 ":" ) ls32
-        return r4
-          .optional ([] (rule const& r4a) {
-            return r4a.star (h16_colon, 0, 1)
-              .concat (h16)
-              .matched ("*1( h16 colon ) h16", r4a);
-          })
-          .concat (colon_colon)
-          .star (h16_colon, 3, 3)
-          .concat (ls32)
-          .matched ("[ *1( h16 colon ) h16 ] \"::\" 3( h16 colon ) ls32", r4);
-      },
-      [] (rule const& r5) {
-        // [ *2( h16 ":" ) h16 ] "::" 2( h16 ":" ) ls32
-        return r5
-          .optional ([] (rule const& r5a) {
-            return r5a.star (h16_colon, 0, 2)
-              .concat (h16)
-              .matched ("*2( h16 colon ) h16", r5a);
-          })
-          .concat (colon_colon)
-          .star (h16_colon, 2, 2)
-          .concat (ls32)
-          .matched ("[ *2( h16 colon ) h16 ] \"::\" 2( h16 colon ) ls32", r5);
-      },
-      [] (rule const& r6) {
-        // [ *3( h16 ":" ) h16 ] "::" h16 ":" ls32
-        return r6
-          .optional ([] (rule const& r6a) {
-            return r6a.star (h16_colon, 0, 3)
-              .concat (h16)
-              .matched ("*3( h16 colon ) h16", r6a);
-          })
-          .concat (colon_colon)
-          .concat (h16_colon)
-          .concat (ls32)
-          .matched ("[ *3( h16 colon ) h16 ] \"::\" h16 colon ls32", r6);
-      },
-      [] (rule const& r7) {
-        // [ *4( h16 ":" ) h16 ] "::" ls32
-        return r7
-          .optional ([] (rule const& r7a) {
-            return r7a.star (h16_colon, 0, 4)
-              .concat (h16)
-              .matched ("*4( h16 colon ) h16", r7a);
-          })
-          .concat (colon_colon)
-          .concat (ls32)
-          .matched ("[ *4( h16 colon ) h16 ] \"::\" ls32", r7);
-      },
-      [] (rule const& r8) {
-        // [ *5( h16 ":" ) h16 ] "::" h16
-        return r8
-          .optional ([] (rule const& r8a) {
-            return r8a.star (h16_colon, 0, 5)
-              .concat (h16)
-              .matched ("*5( h16 colon ) h16", r8a);
-          })
-          .concat (colon_colon)
-          .concat (h16)
-          .matched ("[ *5( h16 colon ) h16 ] \"::\" h16", r8);
-      },
-      [] (rule const& r9) {
-        // [ *6( h16 ":" ) h16 ] "::"
-        return r9
-          .optional ([] (rule const& r9a) {
-            return r9a.star (h16_colon, 0, 6)
-              .concat (h16)
-              .matched ("*6( h16 colon ) h16", r9a);
-          })
-          .concat (colon_colon)
-          .matched ("[ *6( h16 colon ) h16 ] \"::\"", r9);
-      })
-    .matched ("IPv6address", r);
-}
+using ipv6address = named<
+  "IPv6address",
+  alternative<concat<star<h16_colon, 6, 6>, ls32>,                                                       // r1
+              concat<colon_colon, star<h16_colon, 5, 5>, ls32>,                                          // r2
+              concat<optional<h16>, colon_colon, star<h16_colon, 4, 4>, ls32>,                           // r3
+              concat<optional<concat<star<h16_colon, 0, 1>, h16>>, colon_colon, star<h16_colon, 3, 3>, ls32>,  // r4
+              concat<optional<concat<star<h16_colon, 0, 2>, h16>>, colon_colon, star<h16_colon, 2, 2>, ls32>,  // r5
+              concat<optional<concat<star<h16_colon, 0, 3>, h16>>, colon_colon, h16_colon, ls32>,        // r6
+              concat<optional<concat<star<h16_colon, 0, 4>, h16>>, colon_colon, ls32>,                   // r7
+              concat<optional<concat<star<h16_colon, 0, 5>, h16>>, colon_colon, h16>,                    // r8
+              concat<optional<concat<star<h16_colon, 0, 6>, h16>>, colon_colon>>>;                        // r9
 
 // IPvFuture     = "v" 1*HEXDIG "." 1*( unreserved / sub-delims / ":" )
-auto ipvfuture (rule const& r) {
-  return r.concat (latin_small_letter_v)
-    .star (hexdig, 1)
-    .concat (full_stop)
-    .star (
-      [] (rule const& r1) {
-        return r1.alternative (unreserved, sub_delims, colon)
-          .matched ("unreserved / sub-delims / colon", r1);
-      },
-      1)
-    .matched ("IPvFuture", r);
-}
+using ipvfuture = named<"IPvFuture", concat<latin_small_letter_v, star<hexdig, 1>, full_stop,
+                                            star<alternative<unreserved, sub_delims, colon>, 1>>>;
 
 // IP-literal    = "[" ( IPv6address / IPvFuture ) "]"
-auto ip_literal (rule const& r) {
-  return r.concat (left_square_bracket)
-    .concat ([] (rule const& r1) {
-      return r1.alternative (ipv6address, ipvfuture)
-        .matched ("IPv6address / IPvFuture", r1);
-    })
-    .concat (right_square_bracket)
-    .matched ("IP-literal", r);
-}
+using ip_literal =
+  named<"IP-literal", concat<left_square_bracket, alternative<ipv6address, ipvfuture>, right_square_bracket>>;
 
 // host = IP-literal / IPv4address / reg-name
-auto host (rule const& r) {
-  return r.alternative (ip_literal, ipv4address, reg_name)
-    .matched ("IP-literal / IPv4address / reg-name", r);
-}
-constexpr auto hostfn = host;
-
-auto host_rule (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r
-      .concat (hostfn,
-               [&result] (std::string_view host) {
-                 result.ensure_authority ().host = host;
-               })
-      .matched ("host", r);
-  };
-}
-
-auto userinfo_at (uri::parts& result) {
-  // userinfo-at = userinfo "@"
-  return [&result] (rule const& r) {
-    return r
-      .concat (userinfo,
-               [&result] (std::string_view const userinfo) {
-                 result.ensure_authority ().userinfo = userinfo;
-               })
-      .concat (commercial_at)
-      .matched ("userinfo \"@\"", r);
-  };
-}
+using host = named<"host", alternative<ip_literal, ipv4address, reg_name>>;
 
 // port = *DIGIT
-auto port (rule const& r) {
-  return r.star (digit).matched ("port", r);
-}
-constexpr auto portfn = port;
-
-auto colon_port (uri::parts& result) {
-  // colon-port = ":" port
-  return [&result] (rule const& r) {
-    return r.concat (colon)
-      .concat (port,
-               [&result] (std::string_view const p) {
-                 result.ensure_authority ().port = p;
-               })
-      .matched ("\":\" port", r);
-  };
-}
+using port = named<"port", star<digit>>;
 
-auto authority (uri::parts& result) {
-  // authority = [ userinfo "@" ] host [ ":" port ]
-  return [&result] (rule const& r) {
-    return r.optional (userinfo_at (result))
-      .concat (host_rule (result))
-      .optional (colon_port (result))
-      .matched ("authority", r);
-  };
-}
+// authority = [ userinfo "@" ] host [ ":" port ]
+using authority = named<"authority", concat<optional<concat<accept<userinfo, &set_userinfo>, commercial_at>>,
+                                            accept<host, &set_host>, optional<concat<colon, accept<port, &set_port>>>>>;
 
 // segment       = *pchar
-auto segment (rule const& r) {
-  return r.star (pchar).matched ("segment", r);
-}
+using segment = named<"segment", star<pchar>>;
 
 // segment-nz    = 1*pchar
-auto segment_nz (rule const& r) {
-  return r.star (pchar, 1U).matched ("segment-nz", r);
-}
+using segment_nz = named<"segment-nz", star<pchar, 1U>>;
 
 // segment-nz-nc = 1*( unreserved / pct-encoded / sub-delims / "@" )
 //                  ; non-zero-length segment without any colon ":"
-auto segment_nz_nc (rule const& r) {
-  return r
-    .star (
-      [] (rule const& r2) {
-        return r2
-          .alternative (unreserved, pct_encoded, sub_delims, commercial_at)
-          .matched ("unreserved / pct-encoded / sub-delims / \"@\"", r2);
-      },
-      1U)
-    .matched ("segment-nz-nc", r);
-}
+using segment_nz_nc = named<"segment-nz-nc", star<alternative<unreserved, pct_encoded, sub_delims, commercial_at>, 1U>>;
 
+// "/" segment
 template <bool IsAbs>
-class append_dir {
-public:
-  explicit constexpr append_dir (uri::parts& result) noexcept
-      : result_{result} {}
-  void operator() (std::string_view const str) {
-    (void)str;
-    if constexpr (IsAbs) {
-      result_.path.absolute = true;
-    }
-    result_.path.segments.emplace_back ();
-  }
+using solidus_segment = concat<accept<solidus, &append_dir<IsAbs>>, accept<segment, &append_segment>>;
 
-private:
-  uri::parts& result_;
-};
-
-class append_segment {
-public:
-  explicit constexpr append_segment (uri::parts& result) noexcept
-      : result_{result} {}
-  void operator() (std::string_view const seg) {
-    assert (!result_.path.segments.empty ());
-    result_.path.segments.back () = seg;
-  }
-
-private:
-  uri::parts& result_;
-};
-
-class record_initial_segment {
-public:
-  explicit constexpr record_initial_segment (uri::parts& result) noexcept
-      : result_{result} {}
-  void operator() (std::string_view const seg) {
-    result_.path.segments.emplace_back (seg);
-  }
-
-private:
-  uri::parts& result_;
-};
-
-auto path_abempty (uri::parts& result) {
-  // path-abempty  = *( "/" segment )
-  return [&result] (rule const& r) {
-    return r
-      .star ([&result] (rule const& r2) {
-        return r2.concat (solidus, append_dir<true>{result})
-          .concat (segment, append_segment{result})
-          .matched ("\"/\" segment", r2);
-      })
-      .matched ("path-abempty", r);
-  };
-}
+// path-abempty  = *( "/" segment )
+using path_abempty = named<"path-abempty", star<solidus_segment<true>>>;
 
-auto path_absolute (uri::parts& result) {
-  // path-absolute = "/" [ segment-nz *( "/" segment ) ]
-  return [&result] (rule const& r) {
-    return r.concat (solidus, append_dir<true>{result})
-      .optional ([&result] (rule const& r1) {
-        return r1.concat (segment_nz, append_segment{result})
-          .star ([&result] (rule const& r2) {
-            return r2.concat (solidus, append_dir<false>{result})
-              .concat (segment, append_segment{result})
-              .matched ("\"/\" segment", r2);
-          })
-          .matched ("*( \"/\" segment )", r1);
-      })
-      .matched ("path-absolute", r);
-  };
-}
+// path-absolute = "/" [ segment-nz *( "/" segment ) ]
+using path_absolute =
+  named<"path-absolute",
+        concat<accept<solidus, &append_dir<true>>,
+               optional<concat<accept<segment_nz, &append_segment>, star<solidus_segment<false>>>>>>;
 
 // path-noscheme = segment-nz-nc *( "/" segment )
-auto path_noscheme (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r.concat (segment_nz_nc, record_initial_segment{result})
-      .star ([&result] (rule const& r1) {
-        return r1.concat (solidus, append_dir<false>{result})
-          .concat (segment, append_segment{result})
-          .matched ("\"/\" segment", r1);
-      })
-      .matched ("path-noscheme", r);
-  };
-}
+using path_noscheme =
+  named<"path-noscheme", concat<accept<segment_nz_nc, &record_initial_segment>, star<solidus_segment<false>>>>;
 
 // path-empty    = 0<pchar>
-auto path_empty (rule const& r) {
-  return r.star (pchar, 0, 0).matched ("path-empty", r);
-}
+using path_empty = named<"path-empty", star<pchar, 0, 0>>;
 
 // path-rootless = segment-nz *( "/" segment )
-auto path_rootless (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r.concat (segment_nz, record_initial_segment{result})
-      .star ([&result] (rule const& r1) {
-        return r1.concat (solidus, append_dir<false>{result})
-          .concat (segment, append_segment{result})
-          .matched ("\"/\" segment", r1);
-      })
-      .matched ("path-rootless", r);
-  };
-}
+using path_rootless =
+  named<"path-rootless", concat<accept<segment_nz, &record_initial_segment>, star<solidus_segment<false>>>>;
 
 // auth-abempty = "//" authority path-abempty
-auto auth_abempty (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r.concat (solidus)
-      .concat (solidus)
-      .concat (authority (result))
-      .concat (path_abempty (result))
-      .matched ("auth-abempty", r);
-  };
-}
+using auth_abempty = concat<solidus, solidus, authority, path_abempty>;
 
 // relative-part = auth-abempty
 //               / path-absolute
 //               / path-noscheme
 //               / path-empty
-auto relative_part (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r
-      .alternative (auth_abempty (result), path_absolute (result),
-                    path_noscheme (result), path_empty)
-      .matched ("relative-part", r);
-  };
-}
+using relative_part = named<"relative-part", alternative<auth_abempty, path_absolute, path_noscheme, path_empty>>;
 
 // query         = *( pchar / "/" / "?" )
-auto query (rule const& r) {
-  return r
-    .star ([] (rule const& r2) {
-      return r2.alternative (pchar, solidus, question_mark)
-        .matched (R"(pchar / "/" / "?")", r2);
-    })
-    .matched ("query", r);
-}
-constexpr auto queryfn = query;
+using query = named<"query", star<alternative<char_class<ascii::query>, pct_encoded>>>;
 
 // question-query = "?" query
-auto question_query (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r
-      .concat (question_mark)  // "?"
-      .concat (query, [&result] (
-                        std::string_view const query) { result.query = query; })
-      .matched ("question-query", r);
-  };
-}
+using question_query = concat<question_mark, accept<query, &set_query>>;
 
 // fragment      = *( pchar / "/" / "?" )
-auto fragment (rule const& r) {
-  return query (r);
-}
-constexpr auto fragmentfn = fragment;
+using fragment = named<"fragment", star<alternative<char_class<ascii::query>, pct_encoded>>>;
 
 // hash-fragment = "#" fragment
-auto hash_fragment (uri::parts& result) {
-  return [&result] (rule const& rf) {
-    return rf.concat (hash)
-      .concat (fragment,
-               [&result] (std::string_view const fragment) {
-                 result.fragment = fragment;
-               })
-      .matched ("hash-fragment", rf);
-  };
-};
+using hash_fragment = concat<hash, accept<fragment, &set_fragment>>;
 
 // relative-ref  = relative-part [ question-query ] [ hash-fragment ]
-auto relative_ref (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r.concat (relative_part (result))
-      .optional (question_query (result))
-      .optional ([&result] (rule const& rf) {
-        // "#" fragment
-        return rf
-          .concat (hash)  // "#"
-          .concat (       // fragment
-            fragment,
-            [&result] (std::string_view const fragment) {
-              result.fragment = fragment;
-            })
-          .matched ("\"#\" fragment", rf);
-      })
-      .matched ("relative-ref", r);
-  };
-}
-
-// relative-part = auth-abempty
-//               / path-absolute
-//               / path-noscheme
-//               / path-empty
+using relative_ref = named<"relative-ref", concat<relative_part, optional<question_query>, optional<hash_fragment>>>;
 
 // hier-part     = auth-abempty
 //               / path-absolute
 //               / path-rootless
 //               / path-empty
-auto hier_part (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r
-      .alternative (auth_abempty (result), path_absolute (result),
-                    path_rootless (result), path_empty)
-      .matched ("hier-part", r);
-  };
-}
+using hier_part = named<"hier-part", alternative<auth_abempty, path_absolute, path_rootless, path_empty>>;
 
 // URI = scheme ":" hier-part [ "?" query ] [ "#" fragment ]
-auto URI (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r
-      .concat (
-        scheme,
-        [&result] (std::string_view const scheme) { result.scheme = scheme; })
-      .concat (colon)
-      .concat (hier_part (result))
-      .optional (question_query (result))
-      .optional (hash_fragment (result))
-      .matched ("URI", r);
-  };
-}
+using URI = named<"URI", concat<accept<scheme, &set_scheme>, colon, hier_part, optional<question_query>,
+                                optional<hash_fragment>>>;
 
 // URI-reference = URI / relative-ref
-auto URI_reference (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r.alternative (URI (result), relative_ref (result))
-      .matched ("URI-reference", r);
-  };
-}
+using URI_reference = named<"URI-reference", alternative<URI, relative_ref>>;
 
 #if 0
 // absolute-URI  = scheme ":" hier-part [ "?" query ]
-auto absolute_URI (uri::parts& result) {
-  return [&result] (rule const& r) {
-    return r
-      .concat (
-        scheme,
-        [&result] (std::string_view const scheme) { result.scheme = scheme; })
-      .concat (colon)
-      .concat (hier_part (result))
-      .optional (question_query (result))
-      .matched ("absolute-URI", r);
-  };
-}
+using absolute_URI = concat<accept<scheme, &set_scheme>, colon, hier_part, optional<question_query>>;
 #endif
 
+}  // end namespace rfc3986
+
 // merge
 // ~~~~~
 /// An implementation of the algorithm in RFC 3986, section 5.2.3 "Merge Paths"
@@ -726,12 +269,14 @@ auto absolute_URI (uri::parts& result) {
 ///
 /// \param base  The base URL.
 /// \param ref  A relative-path reference.
+/// \param resource  The memory resource used for the merged path's segments.
 /// \result  The merged path.
-struct uri::parts::path merge (uri::parts const& base, uri::parts const& ref) {
+struct uri::parts::path merge (uri::parts const& base, uri::parts const& ref,
+                               std::pmr::memory_resource* const resource) {
   // If the base URI has a defined authority component and an empty path, then
   // return a path consisting of "/" concatenated with the reference's path
   if (base.authority && base.path.empty ()) {
-    struct uri::parts::path r1;
+    struct uri::parts::path r1{false, uri::parts::path::segments_type{resource}};
     r1.absolute = true;
     r1.segments = ref.path.segments;
     return r1;
@@ -739,7 +284,7 @@ struct uri::parts::path merge (uri::parts const& base, uri::parts const& ref) {
 
   // Return a path consisting of the reference's path component appended to all
   // but the last segment of the base URI's path.
-  struct uri::parts::path r2;
+  struct uri::parts::path r2{false, uri::parts::path::segments_type{resource}};
   r2.absolute = base.path.absolute;
 
   auto last = std::end (base.path.segments);
@@ -752,6 +297,38 @@ struct uri::parts::path merge (uri::parts const& base, uri::parts const& ref) {
   return r2;
 }
 
+constexpr bool is_dot_segment (std::string_view const seg) noexcept {
+  auto const length = seg.length ();
+  return length > 0 && length < 3 && seg[0] == '.' && seg[length - 1] == '.';
+}
+
+/// Returns true if \p path contains a "." or ".." segment.
+constexpr bool has_dot_segments (std::string_view const path) noexcept {
+  for (auto pos = path.find ('.'); pos != std::string_view::npos; pos = path.find ('.', pos + 1)) {
+    if (pos > 0 && path[pos - 1] != '/') {
+      continue;  // This dot is not at the start of a segment.
+    }
+    auto const seg = path.substr (pos, path.find ('/', pos) - pos);
+    if (is_dot_segment (seg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Returns the number of characters written by details::compose_path().
+std::size_t path_size (struct uri::parts::path const& path) noexcept {
+  auto const& segments = path.segments;
+  if (segments.empty ()) {
+    return 0;
+  }
+  auto size = segments.size () - (path.absolute ? 0U : 1U);
+  for (auto const& seg : segments) {
+    size += seg.length ();
+  }
+  return size;
+}
+
 }  // end anonymous namespace
 
 namespace uri {
@@ -769,9 +346,15 @@ bool parts::path::operator== (path const& rhs) const {
 void parts::path::remove_dot_segments () {
   auto const begin = std::begin (this->segments);
   auto const end = std::end (this->segments);
-  auto outit = begin;
+  // Most paths have no dot segments and are left unchanged. The segments
+  // ahead of the first dot segment stay where they are.
+  auto const first_dot = std::find_if (begin, end, is_dot_segment);
+  if (first_dot == end) {
+    return;
+  }
+  auto outit = first_dot;
   bool last_dir = false;
-  for (auto it = begin; it != end; ++it) {
+  for (auto it = first_dot; it != end; ++it) {
     if (*it == ".") {
       // '.' means "the current directory": remove it.
       last_dir = true;
@@ -783,7 +366,9 @@ void parts::path::remove_dot_segments () {
         --outit;
       }
     } else {
-      last_dir = it->empty ();
+      // An empty segment is copied like any other: a trailing one already
+      // gives the path its final "/".
+      last_dir = false;
       if (outit != it) {
         *outit = *it;
       }
@@ -792,25 +377,74 @@ void parts::path::remove_dot_segments () {
   }
   this->segments.erase (outit, end);
 
+  // A path which ends with a dot segment ends with "/". This needs a new empty
+  // segment even if the output already ends with one: "/a//." is "/a//".
   if (last_dir) {
-    if (segments.empty ()) {
-      this->segments.emplace_back ();
+    this->segments.emplace_back ();
+  }
+}
+
+std::optional<std::size_t> remove_dot_segments (std::string_view path, std::span<char> const buffer) noexcept {
+  if (buffer.size () < path.length ()) {
+    return std::nullopt;
+  }
+  auto* const out = buffer.data ();
+  if (!has_dot_segments (path)) {
+    std::copy (path.begin (), path.end (), out);
+    return path.length ();
+  }
+  auto size = std::size_t{0};
+  // Removes the last segment and its preceding "/" (if any) from the output.
+  auto const pop = [out, &size] () {
+    while (size > 0 && out[size - 1] != '/') {
+      --size;
+    }
+    if (size > 0) {
+      --size;
+    }
+  };
+  // The steps of RFC 3986 section 5.2.4 "Remove Dot Segments".
+  while (!path.empty ()) {
+    if (path.starts_with ("../")) {
+      path.remove_prefix (3);  // A.
+    } else if (path.starts_with ("./")) {
+      path.remove_prefix (2);  // A.
+    } else if (path.starts_with ("/./")) {
+      path.remove_prefix (2);  // B.
+    } else if (path == "/.") {
+      path = "/";  // B.
+    } else if (path.starts_with ("/../")) {
+      path.remove_prefix (3);  // C.
+      pop ();
+    } else if (path == "/..") {
+      path = "/";  // C.
+      pop ();
+    } else if (path == "." || path == "..") {
+      path = std::string_view{};  // D.
     } else {
-      if (!this->segments.back ().empty ()) {
-        this->segments.emplace_back ();
-      }
+      // E. Move the first segment, including its initial "/" if any, to the
+      // output.
+      auto const end = path.find ('/', 1);
+      auto const seg = path.substr (0, end);
+      std::copy (seg.begin (), seg.end (), out + size);
+      size += seg.length ();
+      path.remove_prefix (seg.length ());
     }
   }
+  return size;
+}
+
+std::string remove_dot_segments (std::string_view const path) {
+  std::string result;
+  result.resize (path.length ());
+  result.resize (*remove_dot_segments (path, std::span<char>{result}));
+  return result;
 }
 
 parts::path::operator std::string () const {
   std::string p;
-  auto const* separator = absolute ? "/" : "";
-  for (auto const& seg : segments) {
-    p += separator;
-    p += seg;
-    separator = "/";
-  }
+  p.resize (path_size (*this));
+  details::compose_path (*this, p.data ());
   return p;
 }
 
@@ -827,7 +461,7 @@ parts::path::operator std::filesystem::path () const {
 
 bool parts::path::valid () const noexcept {
   for (auto const& seg : segments) {
-    if (!rule{seg}.concat (segment).done ()) {
+    if (!grammar::matches<rfc3986::segment> (seg)) {
       return false;
     }
   }
@@ -839,22 +473,20 @@ bool parts::authority::operator== (authority const& rhs) const {
 }
 
 bool parts::authority::valid () const noexcept {
-  if (userinfo.has_value () &&
-      !rule{userinfo.value ()}.concat (userinfofn).done ()) {
+  if (userinfo.has_value () && !grammar::matches<rfc3986::userinfo> (userinfo.value ())) {
     return false;
   }
-  if (!rule{host}.concat (hostfn).done ()) {
+  if (!grammar::matches<rfc3986::host> (host)) {
     return false;
   }
-  if (port.has_value () && !rule{port.value ()}.concat (portfn).done ()) {
+  if (port.has_value () && !grammar::matches<rfc3986::port> (port.value ())) {
     return false;
   }
   return true;
 }
 
 bool parts::valid () const noexcept {
-  if (!this->scheme.has_value () ||
-      !rule{this->scheme.value ()}.concat (schemefn).done ()) {
+  if (!this->scheme.has_value () || !grammar::matches<rfc3986::scheme> (this->scheme.value ())) {
     return false;
   }
   if (this->authority.has_value () && !this->authority->valid ()) {
@@ -863,12 +495,10 @@ bool parts::valid () const noexcept {
   if (!this->path.valid ()) {
     return false;
   }
-  if (this->query.has_value () &&
-      !rule{this->query.value ()}.concat (queryfn).done ()) {
+  if (this->query.has_value () && !grammar::matches<rfc3986::query> (this->query.value ())) {
     return false;
   }
-  if (this->fragment.has_value () &&
-      !rule{this->fragment.value ()}.concat (fragmentfn).done ()) {
+  if (this->fragment.has_value () && !grammar::matches<rfc3986::fragment> (this->fragment.value ())) {
     return false;
   }
   return true;
@@ -893,17 +523,172 @@ bool parts::operator== (parts const& rhs) const {
   return true;
 }
 
-std::optional<parts> split (std::string_view const in) {
-  if (parts result; rule{in}.concat (URI (result)).done ()) {
+namespace {
+
+/// Matches \p in against the grammar production \p Rule.
+template <typename Rule>
+std::optional<parts> split_rule (std::string_view const in, grammar::memoization const memo,
+                                 std::pmr::memory_resource* const resource) {
+  if (parts result = make_parts (resource); grammar::parse<Rule> (in, result, memo, resource)) {
     return result;
   }
   return {};
 }
-std::optional<parts> split_reference (std::string_view const in) {
-  if (parts result; rule{in}.concat (URI_reference (result)).done ()) {
+
+/// Matches \p in against the grammar production \p Rule. If backtracking
+/// causes more characters to be scanned a second time than are permitted by
+/// \p budget, the attempt is abandoned.
+template <typename Rule>
+std::variant<std::error_code, parts> split_budgeted (std::string_view const in, split_budget const& budget,
+                                                     std::pmr::memory_resource* const resource) {
+  grammar::context<parts> ctx{in, resource};
+  ctx.set_budget (budget.limit (in.length ()));
+  if (parts result = make_parts (resource); Rule::match (ctx) && ctx.done (result)) {
     return result;
   }
-  return {};
+  return make_error_code (ctx.exhausted () ? split_error::budget_exhausted : split_error::bad_syntax);
+}
+
+}  // end anonymous namespace
+
+namespace details {
+
+bool within (std::string_view const outer, std::string_view const inner) noexcept {
+  // std::less_equal<> provides a total order on pointers which need not point
+  // into the same object.
+  constexpr auto le = std::less_equal<> ();
+  auto const* const first = inner.data ();
+  return first != nullptr && le (outer.data (), first) && le (first + inner.length (), outer.data () + outer.length ());
+}
+
+std::optional<parts> split_rules (std::string_view const in, grammar::memoization const memo) {
+  return split_rule<rfc3986::URI> (in, memo, std::pmr::get_default_resource ());
+}
+std::optional<parts> split_reference_rules (std::string_view const in, grammar::memoization const memo) {
+  return split_rule<rfc3986::URI_reference> (in, memo, std::pmr::get_default_resource ());
+}
+
+bool valid_authority (std::string_view const auth, struct parts::authority& result) {
+  switch (scan_authority (auth, result)) {
+  case scan_result::success: return true;
+  case scan_result::failure: return false;
+  case scan_result::fallback: break;
+  }
+  parts p;
+  grammar::context<parts> ctx{auth};
+  if (!rfc3986::authority::match (ctx) || !ctx.done (p)) {
+    return false;
+  }
+  result = p.ensure_authority ();
+  return true;
+}
+
+}  // end namespace details
+
+std::optional<parts> split (std::string_view const in, std::pmr::memory_resource* const resource) {
+  parts result = make_parts (resource);
+  switch (details::scan (in, false, result)) {
+  case details::scan_result::success: return result;
+  case details::scan_result::failure: return {};
+  case details::scan_result::fallback: break;
+  }
+  return split_rule<rfc3986::URI> (in, grammar::memoization::off, resource);
+}
+std::optional<parts> split_reference (std::string_view const in, std::pmr::memory_resource* const resource) {
+  parts result = make_parts (resource);
+  switch (details::scan (in, true, result)) {
+  case details::scan_result::success: return result;
+  case details::scan_result::failure: return {};
+  case details::scan_result::fallback: break;
+  }
+  return split_rule<rfc3986::URI_reference> (in, grammar::memoization::off, resource);
+}
+
+std::variant<std::error_code, parts> split (std::string_view const in, split_budget const& budget,
+                                            std::pmr::memory_resource* const resource) {
+  parts result = make_parts (resource);
+  switch (details::scan (in, false, result)) {
+  case details::scan_result::success: return result;
+  case details::scan_result::failure: return make_error_code (split_error::bad_syntax);
+  case details::scan_result::fallback: break;
+  }
+  return split_budgeted<rfc3986::URI> (in, budget, resource);
+}
+std::variant<std::error_code, parts> split_reference (std::string_view const in, split_budget const& budget,
+                                                      std::pmr::memory_resource* const resource) {
+  parts result = make_parts (resource);
+  switch (details::scan (in, true, result)) {
+  case details::scan_result::success: return result;
+  case details::scan_result::failure: return make_error_code (split_error::bad_syntax);
+  case details::scan_result::fallback: break;
+  }
+  return split_budgeted<rfc3986::URI_reference> (in, budget, resource);
+}
+
+namespace details {
+
+std::optional<parts> split_fields (std::string_view const in, bool const reference, field_mask const fields,
+                                   bool const strict, std::pmr::memory_resource* const resource) {
+  if (!strict) {
+    parts result = make_parts (resource);
+    if (scan_fields (in, reference, fields, result) != scan_result::success) {
+      return std::nullopt;
+    }
+    return result;
+  }
+  // Strict validation requires a complete split. Discard the components that
+  // were not requested.
+  auto result = reference ? split_reference (in, resource) : split (in, resource);
+  if (!result) {
+    return result;
+  }
+  if (!includes (fields, field_mask::scheme)) {
+    result->scheme.reset ();
+  }
+  if (!includes (fields, field_mask::authority)) {
+    result->authority.reset ();
+  } else if (result->authority) {
+    if (!includes (fields, field_mask::userinfo)) {
+      result->authority->userinfo.reset ();
+    }
+    if (!includes (fields, field_mask::host)) {
+      result->authority->host = std::string_view{};
+    }
+    if (!includes (fields, field_mask::port)) {
+      result->authority->port.reset ();
+    }
+  }
+  if (!includes (fields, field_mask::path)) {
+    result->path.absolute = false;
+    result->path.segments.clear ();
+  }
+  if (!includes (fields, field_mask::query)) {
+    result->query.reset ();
+  }
+  if (!includes (fields, field_mask::fragment)) {
+    result->fragment.reset ();
+  }
+  return result;
+}
+
+}  // end namespace details
+
+// split error category
+// ~~~~~~~~~~~~~~~~~~~~
+char const* split_error_category::name () const noexcept {
+  return "uri split";
+}
+std::string split_error_category::message (int const error) const {
+  switch (static_cast<split_error> (error)) {
+  case split_error::bad_syntax: return "bad syntax";
+  case split_error::budget_exhausted: return "work budget exhausted";
+  case split_error::none: return "unknown error";
+  default: return "unknown error";
+  }
+}
+std::error_code make_error_code (split_error const e) {
+  static split_error_category category;
+  return {static_cast<int> (e), category};
 }
 
 std::ostream& operator<< (std::ostream& os,
@@ -924,7 +709,8 @@ std::ostream& operator<< (std::ostream& os,
 }
 
 std::ostream& operator<< (std::ostream& os, struct parts::path const& path) {
-  return os << static_cast<std::string> (path);
+  details::compose_path (path, std::ostreambuf_iterator<char>{os});
+  return os;
 }
 
 // join
@@ -936,8 +722,9 @@ std::ostream& operator<< (std::ostream& os, struct parts::path const& path) {
 /// \param base  The base URI.
 /// \param reference The URI reference.
 /// \param strict  Strict mode.
+/// \param resource  The memory resource used for the target's path segments.
 /// \result  The target URI.
-parts join (parts const& base, parts const& reference, bool strict) {
+parts join (parts const& base, parts const& reference, bool strict, std::pmr::memory_resource* const resource) {
   // In "non-strict" mode we ignore a scheme in the reference if it is identical
   // to the base URI's scheme.
   std::optional<std::string_view> empty;
@@ -946,7 +733,7 @@ parts join (parts const& base, parts const& reference, bool strict) {
     ref_scheme = &empty;
   }
 
-  parts target;
+  parts target = make_parts (resource);
   if (*ref_scheme) {
     target.scheme = *ref_scheme;
     target.authority = reference.authority;
@@ -969,7 +756,7 @@ parts join (parts const& base, parts const& reference, bool strict) {
           target.path = reference.path;
           target.path.remove_dot_segments ();
         } else {
-          target.path = merge (base, reference);
+          target.path = merge (base, reference, resource);
           target.path.remove_dot_segments ();
         }
         target.query = reference.query;
@@ -982,17 +769,17 @@ parts join (parts const& base, parts const& reference, bool strict) {
   return target;
 }
 
-std::optional<parts> join (std::string_view base, std::string_view reference,
-                           bool strict) {
-  auto const base_parts = split (base);
+std::optional<parts> join (std::string_view base, std::string_view reference, bool strict,
+                           std::pmr::memory_resource* const resource) {
+  auto const base_parts = split (base, resource);
   if (!base_parts) {
     return {};
   }
-  auto const reference_parts = split_reference (reference);
+  auto const reference_parts = split_reference (reference, resource);
   if (!reference_parts) {
     return {};
   }
-  return join (*base_parts, *reference_parts, strict);
+  return join (*base_parts, *reference_parts, strict, resource);
 }
 
 std::ostream& compose (std::ostream& os, parts const& p) {
@@ -1015,14 +802,61 @@ std::ostream& compose (std::ostream& os, parts const& p) {
   return os;
 }
 
+std::size_t composed_size (parts const& p) noexcept {
+  auto size = std::size_t{0};
+  if (p.scheme.has_value ()) {
+    size += p.scheme->length () + 1;
+  }
+  if (p.authority.has_value ()) {
+    auto const& auth = *p.authority;
+    size += 2 + auth.host.length ();
+    if (auth.userinfo.has_value ()) {
+      size += auth.userinfo->length () + 1;
+    }
+    if (auth.port.has_value ()) {
+      size += auth.port->length () + 1;
+    }
+    if (!p.path.empty () && !p.path.absolute) {
+      ++size;
+    }
+  }
+  size += path_size (p.path);
+  if (p.query.has_value ()) {
+    size += p.query->length () + 1;
+  }
+  if (p.fragment.has_value ()) {
+    size += p.fragment->length () + 1;
+  }
+  return size;
+}
+
+std::optional<std::size_t> compose_into (parts const& p, std::span<char> const buffer) noexcept {
+  auto const size = composed_size (p);
+  if (size > buffer.size ()) {
+    return std::nullopt;
+  }
+  compose_to (p, buffer.data ());
+  return size;
+}
+
 std::string compose (parts const& p) {
-  std::stringstream result;
-  result << p;
-  return result.str ();
+  std::string result;
+  result.resize (composed_size (p));
+  compose_to (p, result.data ());
+  return result;
 }
 
 std::ostream& operator<< (std::ostream& os, parts const& p) {
   return compose (os, p);
 }
 
+std::optional<std::string> join_to_string (std::string_view const base, std::string_view const reference,
+                                           bool const strict) {
+  std::string out;
+  if (!join_to (base, reference, std::back_inserter (out), strict)) {
+    return std::nullopt;
+  }
+  return out;
+}
+
 }  // end namespace uri
@@ -0,0 +1,474 @@
+//===- tools/abnf2cpp/abnf.cpp --------------------------------------------===//
+//*        _            __  *
+//*   __ _| |__  _ __  / _| *
+//*  / _` | '_ \| '_ \| |_  *
+//* | (_| | |_) | | | |  _| *
+//*  \__,_|_.__/|_| |_|_|   *
+//*                         *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "abnf.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+/// Case-insensitive comparison is needed for char-val strings: these must be
+/// locale-independent.
+constexpr char ascii_lower (char const c) noexcept {
+  return c >= 'A' && c <= 'Z' ? static_cast<char> (c - 'A' + 'a') : c;
+}
+constexpr char ascii_upper (char const c) noexcept {
+  return c >= 'a' && c <= 'z' ? static_cast<char> (c - 'a' + 'A') : c;
+}
+constexpr bool is_alpha (char const c) noexcept {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+constexpr bool is_digit (char const c) noexcept {
+  return c >= '0' && c <= '9';
+}
+constexpr bool is_wsp (char const c) noexcept {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void insert (abnf::char_set& set, unsigned const c) {
+  set[c / 64U] |= std::uint64_t{1} << (c % 64U);
+}
+
+std::unique_ptr<abnf::node> make_chars (abnf::char_set const& set, unsigned const line) {
+  auto result = std::make_unique<abnf::node> ();
+  result->k = abnf::node::kind::chars;
+  result->set = set;
+  result->line = line;
+  return result;
+}
+
+/// A recursive-descent parser for the elements of a single rule.
+class rule_parser {
+public:
+  rule_parser (std::string_view const text, std::string const& file, unsigned const line)
+      : text_{text}, file_{file}, line_{line} {}
+
+  std::unique_ptr<abnf::node> elements () {
+    auto result = this->alternation ();
+    this->skip_ws ();
+    if (pos_ != text_.length ()) {
+      this->fail ("unexpected '" + std::string{1, text_[pos_]} + "'");
+    }
+    return result;
+  }
+
+private:
+  [[noreturn]] void fail (std::string const& message) const { throw abnf::error{file_, line_, message}; }
+
+  void skip_ws () {
+    while (pos_ < text_.length () && is_wsp (text_[pos_])) {
+      ++pos_;
+    }
+  }
+  [[nodiscard]] bool at_end () const noexcept { return pos_ >= text_.length (); }
+  [[nodiscard]] char peek () const noexcept { return this->at_end () ? '\0' : text_[pos_]; }
+
+  std::unique_ptr<abnf::node> alternation () {
+    auto result = std::make_unique<abnf::node> ();
+    result->k = abnf::node::kind::alternation;
+    result->line = line_;
+    for (;;) {
+      result->children.push_back (this->concatenation ());
+      this->skip_ws ();
+      if (this->peek () != '/') {
+        break;
+      }
+      ++pos_;
+    }
+    if (result->children.size () == 1U) {
+      return std::move (result->children.front ());
+    }
+    return result;
+  }
+
+  std::unique_ptr<abnf::node> concatenation () {
+    auto result = std::make_unique<abnf::node> ();
+    result->k = abnf::node::kind::concatenation;
+    result->line = line_;
+    for (;;) {
+      this->skip_ws ();
+      if (auto const c = this->peek (); this->at_end () || c == '/' || c == ')' || c == ']') {
+        break;
+      }
+      result->children.push_back (this->repetition ());
+    }
+    if (result->children.empty ()) {
+      this->fail ("expected an element");
+    }
+    if (result->children.size () == 1U) {
+      return std::move (result->children.front ());
+    }
+    return result;
+  }
+
+  unsigned number (unsigned const base) {
+    auto const digit_value = [base] (char const c) -> unsigned {
+      unsigned v = base;
+      if (is_digit (c)) {
+        v = static_cast<unsigned> (c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        v = static_cast<unsigned> (c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        v = static_cast<unsigned> (c - 'A' + 10);
+      }
+      return v < base ? v : base;
+    };
+    auto const start = pos_;
+    auto result = 0U;
+    while (!this->at_end () && digit_value (this->peek ()) < base) {
+      auto const v = digit_value (this->peek ());
+      if (result > (std::numeric_limits<unsigned>::max () - v) / base) {
+        this->fail ("number too large");
+      }
+      result = result * base + v;
+      ++pos_;
+    }
+    if (pos_ == start) {
+      this->fail ("expected a number");
+    }
+    return result;
+  }
+
+  std::unique_ptr<abnf::node> repetition () {
+    auto min = 1U;
+    auto max = 1U;
+    if (is_digit (this->peek ()) || this->peek () == '*') {
+      min = is_digit (this->peek ()) ? this->number (10) : 0U;
+      max = min;
+      if (this->peek () == '*') {
+        ++pos_;
+        max = is_digit (this->peek ()) ? this->number (10) : abnf::node::unbounded;
+      }
+      if (max < min) {
+        this->fail ("repetition maximum is less than its minimum");
+      }
+    }
+    auto element = this->element ();
+    if (min == 1U && max == 1U) {
+      return element;
+    }
+    auto result = std::make_unique<abnf::node> ();
+    result->k = abnf::node::kind::repetition;
+    result->line = line_;
+    result->min = min;
+    result->max = max;
+    result->children.push_back (std::move (element));
+    return result;
+  }
+
+  std::unique_ptr<abnf::node> element () {
+    auto const c = this->peek ();
+    if (is_alpha (c)) {
+      return this->rule_ref (this->rulename ());
+    }
+    switch (c) {
+    case '(': {
+      ++pos_;
+      auto result = this->alternation ();
+      this->expect (')');
+      return result;
+    }
+    case '[': {
+      ++pos_;
+      auto result = std::make_unique<abnf::node> ();
+      result->k = abnf::node::kind::repetition;
+      result->line = line_;
+      result->min = 0;
+      result->max = 1;
+      result->children.push_back (this->alternation ());
+      this->expect (']');
+      return result;
+    }
+    case '"': return this->char_val (false);
+    case '%': return this->percent ();
+    case '<': {
+      // A prose-val. It is interpreted as a reference to the rule that it
+      // names.
+      ++pos_;
+      auto const end = text_.find ('>', pos_);
+      if (end == std::string_view::npos) {
+        this->fail ("unterminated prose-val");
+      }
+      auto name = std::string{text_.substr (pos_, end - pos_)};
+      pos_ = end + 1;
+      return this->rule_ref (std::move (name));
+    }
+    default: break;
+    }
+    this->fail (this->at_end () ? "expected an element" : "unexpected '" + std::string{1, c} + "'");
+  }
+
+  void expect (char const c) {
+    this->skip_ws ();
+    if (this->peek () != c) {
+      this->fail ("expected '" + std::string{1, c} + "'");
+    }
+    ++pos_;
+  }
+
+  std::string rulename () {
+    auto const start = pos_;
+    while (!this->at_end () && (is_alpha (this->peek ()) || is_digit (this->peek ()) || this->peek () == '-')) {
+      ++pos_;
+    }
+    return std::string{text_.substr (start, pos_ - start)};
+  }
+
+  std::unique_ptr<abnf::node> rule_ref (std::string name) const {
+    auto result = std::make_unique<abnf::node> ();
+    result->k = abnf::node::kind::rule_ref;
+    result->line = line_;
+    result->name = std::move (name);
+    return result;
+  }
+
+  /// char-val = DQUOTE *(%x20-21 / %x23-7E) DQUOTE
+  std::unique_ptr<abnf::node> char_val (bool const case_sensitive) {
+    assert (this->peek () == '"');
+    ++pos_;
+    auto const end = text_.find ('"', pos_);
+    if (end == std::string_view::npos) {
+      this->fail ("unterminated string");
+    }
+    auto const str = text_.substr (pos_, end - pos_);
+    pos_ = end + 1;
+
+    auto result = std::make_unique<abnf::node> ();
+    result->k = abnf::node::kind::concatenation;
+    result->line = line_;
+    for (auto const ch : str) {
+      abnf::char_set set{};
+      if (case_sensitive) {
+        insert (set, static_cast<unsigned char> (ch));
+      } else {
+        insert (set, static_cast<unsigned char> (ascii_lower (ch)));
+        insert (set, static_cast<unsigned char> (ascii_upper (ch)));
+      }
+      result->children.push_back (make_chars (set, line_));
+    }
+    if (result->children.size () == 1U) {
+      return std::move (result->children.front ());
+    }
+    if (result->children.empty ()) {
+      // An empty string matches the empty sequence.
+      result->k = abnf::node::kind::repetition;
+      result->min = 0;
+      result->max = 0;
+      result->children.push_back (make_chars (abnf::char_set{}, line_));
+    }
+    return result;
+  }
+
+  /// num-val = "%" (bin-val / dec-val / hex-val). Also handles the %s and %i
+  /// string prefixes of RFC 7405.
+  std::unique_ptr<abnf::node> percent () {
+    ++pos_;
+    auto base = 0U;
+    switch (ascii_lower (this->peek ())) {
+    case 's':
+      ++pos_;
+      return this->char_val (true);
+    case 'i':
+      ++pos_;
+      return this->char_val (false);
+    case 'b': base = 2; break;
+    case 'd': base = 10; break;
+    case 'x': base = 16; break;
+    default: this->fail ("expected 'b', 'd', 'x', 's', or 'i' after '%'");
+    }
+    ++pos_;
+    auto const check = [this] (unsigned const v) {
+      if (v > 0xFFU) {
+        this->fail ("character value is out of range");
+      }
+      return v;
+    };
+    auto const first = check (this->number (base));
+    if (this->peek () == '-') {
+      ++pos_;
+      auto const last = check (this->number (base));
+      if (last < first) {
+        this->fail ("empty character range");
+      }
+      abnf::char_set set{};
+      for (auto v = first; v <= last; ++v) {
+        insert (set, v);
+      }
+      return make_chars (set, line_);
+    }
+    auto result = std::make_unique<abnf::node> ();
+    result->k = abnf::node::kind::concatenation;
+    result->line = line_;
+    abnf::char_set set{};
+    insert (set, first);
+    result->children.push_back (make_chars (set, line_));
+    while (this->peek () == '.') {
+      ++pos_;
+      abnf::char_set s{};
+      insert (s, check (this->number (base)));
+      result->children.push_back (make_chars (s, line_));
+    }
+    if (result->children.size () == 1U) {
+      return std::move (result->children.front ());
+    }
+    return result;
+  }
+
+  std::string_view text_;
+  std::string const& file_;
+  unsigned line_;
+  std::size_t pos_ = 0;
+};
+
+/// Removes a comment from \p line. Semicolons within quoted strings or prose
+/// do not start a comment.
+std::string_view strip_comment (std::string_view const line) {
+  char close = '\0';
+  for (auto pos = std::size_t{0}; pos < line.length (); ++pos) {
+    auto const c = line[pos];
+    if (close != '\0') {
+      if (c == close) {
+        close = '\0';
+      }
+    } else if (c == '"') {
+      close = '"';
+    } else if (c == '<') {
+      close = '>';
+    } else if (c == ';') {
+      return line.substr (0, pos);
+    }
+  }
+  return line;
+}
+
+constexpr auto core_rules = std::string_view{R"(
+ALPHA          =  %x41-5A / %x61-7A
+BIT            =  "0" / "1"
+CHAR           =  %x01-7F
+CR             =  %x0D
+CRLF           =  CR LF
+CTL            =  %x00-1F / %x7F
+DIGIT          =  %x30-39
+DQUOTE         =  %x22
+HEXDIG         =  DIGIT / "A" / "B" / "C" / "D" / "E" / "F"
+HTAB           =  %x09
+LF             =  %x0A
+LWSP           =  *(WSP / CRLF WSP)
+OCTET          =  %x00-FF
+SP             =  %x20
+VCHAR          =  %x21-7E
+WSP            =  SP / HTAB
+)"};
+
+}  // end anonymous namespace
+
+namespace abnf {
+
+error::error (std::string const& file, unsigned const line, std::string const& message)
+    : std::runtime_error{file + ':' + std::to_string (line) + ": " + message} {}
+
+std::string lower (std::string_view const str) {
+  std::string result;
+  result.reserve (str.length ());
+  std::transform (str.begin (), str.end (), std::back_inserter (result), ascii_lower);
+  return result;
+}
+
+void parse (std::string_view text, std::string const& file, grammar& g) {
+  // Gather each rule's text, joining continuation lines (which begin with
+  // white space) to the line that precedes them.
+  struct pending {
+    std::string text;
+    unsigned line;
+  };
+  std::vector<pending> rules;
+  auto line_number = 0U;
+  while (!text.empty ()) {
+    ++line_number;
+    auto const eol = text.find ('\n');
+    auto line = strip_comment (text.substr (0, eol));
+    text.remove_prefix (eol == std::string_view::npos ? text.length () : eol + 1);
+    if (std::all_of (line.begin (), line.end (), is_wsp)) {
+      continue;
+    }
+    if (is_wsp (line.front ())) {
+      if (rules.empty ()) {
+        throw error{file, line_number, "continuation line without a rule"};
+      }
+      rules.back ().text += ' ';
+      rules.back ().text += line;
+    } else {
+      rules.push_back ({std::string{line}, line_number});
+    }
+  }
+
+  for (auto const& [rule_text, line] : rules) {
+    auto const sv = std::string_view{rule_text};
+    auto pos = std::size_t{0};
+    while (pos < sv.length () && (is_alpha (sv[pos]) || is_digit (sv[pos]) || sv[pos] == '-')) {
+      ++pos;
+    }
+    if (pos == 0 || !is_alpha (sv.front ())) {
+      throw error{file, line, "expected a rule name"};
+    }
+    auto const name = sv.substr (0, pos);
+    while (pos < sv.length () && is_wsp (sv[pos])) {
+      ++pos;
+    }
+    if (pos >= sv.length () || sv[pos] != '=') {
+      throw error{file, line, "expected '=' or '=/'"};
+    }
+    ++pos;
+    bool const incremental = pos < sv.length () && sv[pos] == '/';
+    if (incremental) {
+      ++pos;
+    }
+    auto definition = rule_parser{sv.substr (pos), file, line}.elements ();
+
+    auto const key = lower (name);
+    auto it = g.find (key);
+    if (incremental) {
+      if (it == g.end ()) {
+        throw error{file, line, "incremental alternative for undefined rule '" + std::string{name} + "'"};
+      }
+      auto& def = it->second.definition;
+      if (def->k != node::kind::alternation) {
+        auto alt = std::make_unique<node> ();
+        alt->k = node::kind::alternation;
+        alt->line = def->line;
+        alt->children.push_back (std::move (def));
+        def = std::move (alt);
+      }
+      def->children.push_back (std::move (definition));
+    } else {
+      if (it != g.end ()) {
+        throw error{file, line, "rule '" + std::string{name} + "' is already defined"};
+      }
+      g.emplace (key, rule{std::string{name}, std::move (definition), file, line});
+    }
+  }
+}
+
+void add_core_rules (grammar& g) {
+  grammar core;
+  parse (core_rules, "<core>", core);
+  for (auto& [key, r] : core) {
+    if (g.find (key) == g.end ()) {
+      g.emplace (key, std::move (r));
+    }
+  }
+}
+
+}  // end namespace abnf
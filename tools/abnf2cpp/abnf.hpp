@@ -0,0 +1,73 @@
+//===- tools/abnf2cpp/abnf.hpp ----------------------------*- mode: C++ -*-===//
+//*        _            __  *
+//*   __ _| |__  _ __  / _| *
+//*  / _` | '_ \| '_ \| |_  *
+//* | (_| | |_) | | | |  _| *
+//*  \__,_|_.__/|_| |_|_|   *
+//*                         *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#ifndef ABNF2CPP_ABNF_HPP
+#define ABNF2CPP_ABNF_HPP
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "uri/automaton.hpp"
+
+namespace abnf {
+
+using char_set = uri::automaton::char_set;
+
+/// A node in the syntax tree of an ABNF rule definition.
+struct node {
+  enum class kind { alternation, concatenation, repetition, rule_ref, chars };
+
+  kind k = kind::concatenation;
+  std::vector<std::unique_ptr<node>> children;  ///< alternation, concatenation, repetition (one child)
+  unsigned min = 1;                             ///< repetition
+  unsigned max = 1;                             ///< repetition: unbounded is represented as unbounded
+  std::string name;                             ///< rule_ref
+  char_set set{};                               ///< chars
+  unsigned line = 0;
+
+  static constexpr auto unbounded = ~0U;
+};
+
+struct rule {
+  std::string name;  ///< The name as written where the rule was first defined.
+  std::unique_ptr<node> definition;
+  std::string file;  ///< The file in which the rule was defined.
+  unsigned line = 0;
+};
+
+/// A grammar is a collection of rules indexed by their lower-case names. (ABNF
+/// rule names are case-insensitive.)
+using grammar = std::map<std::string, rule>;
+
+class error : public std::runtime_error {
+public:
+  error (std::string const& file, unsigned line, std::string const& message);
+};
+
+std::string lower (std::string_view str);
+
+/// Parses the ABNF text \p text and adds its rules to \p g. The text need not
+/// define the core rules of RFC 5234 Appendix B: call add_core_rules() to
+/// supply those that are not otherwise defined.
+void parse (std::string_view text, std::string const& file, grammar& g);
+
+/// Adds the core rules of RFC 5234 Appendix B that are not already defined by
+/// \p g.
+void add_core_rules (grammar& g);
+
+}  // end namespace abnf
+
+#endif  // ABNF2CPP_ABNF_HPP
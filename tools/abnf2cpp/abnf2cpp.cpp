@@ -0,0 +1,302 @@
+//===- tools/abnf2cpp/abnf2cpp.cpp ----------------------------------------===//
+//*        _            __ ____                   *
+//*   __ _| |__  _ __  / _|___ \ ___ _ __  _ __   *
+//*  / _` | '_ \| '_ \| |_  __) / __| '_ \| '_ \  *
+//* | (_| | |_) | | | |  _|/ __/ (__| |_) | |_) | *
+//*  \__,_|_.__/|_| |_|_| |_____\___| .__/| .__/  *
+//*                                 |_|   |_|     *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abnf.hpp"
+#include "nfa.hpp"
+
+// abnf2cpp reads an ABNF grammar (RFC 5234) and writes a C++ header which
+// contains a table-driven recognizer for each of the requested start rules.
+// For a start rule named "R", the header defines:
+//
+// - recognize_R(std::string_view) which returns true if the string matches R.
+//   This uses a minimal DFA.
+// - parse_R(std::string_view, Hook) which, if the string matches R, calls
+//   hook(capture, text) for each instance of the rules named by --capture and
+//   returns true.
+//
+// The grammar must not be recursive.
+//
+// Usage: abnf2cpp [--namespace ns] [--start rule]... [--capture rule]...
+//                 [-o output] input.abnf
+
+namespace {
+
+struct options {
+  std::string name_space = "abnf";
+  std::vector<std::string> start;
+  std::vector<std::string> captures;
+  std::filesystem::path output;
+  std::filesystem::path input;
+};
+
+void usage (std::ostream& os, char const* const argv0) {
+  os << "Usage: " << argv0
+     << " [--namespace ns] [--start rule]... [--capture rule]... [-o output] input.abnf\n"
+        "  --namespace ns  The namespace of the generated code (default: abnf)\n"
+        "  --start rule    Generate a recognizer for rule\n"
+        "  --capture rule  Report matches of rule to the parse hook\n"
+        "  -o output       The output file (default: stdout)\n";
+}
+
+bool parse_options (int const argc, char const* argv[], options& opts) {
+  for (int arg = 1; arg < argc; ++arg) {
+    auto const a = std::string_view{argv[arg]};
+    auto const value = [&] (std::string_view const name) -> char const* {
+      if (arg + 1 >= argc) {
+        std::cerr << "Error: " << name << " requires an argument\n";
+        return nullptr;
+      }
+      return argv[++arg];
+    };
+    if (a == "--namespace") {
+      auto const v = value (a);
+      if (v == nullptr) {
+        return false;
+      }
+      opts.name_space = v;
+    } else if (a == "--start") {
+      auto const v = value (a);
+      if (v == nullptr) {
+        return false;
+      }
+      opts.start.emplace_back (v);
+    } else if (a == "--capture") {
+      auto const v = value (a);
+      if (v == nullptr) {
+        return false;
+      }
+      opts.captures.emplace_back (v);
+    } else if (a == "-o") {
+      auto const v = value (a);
+      if (v == nullptr) {
+        return false;
+      }
+      opts.output = v;
+    } else if (a == "--help") {
+      usage (std::cout, argv[0]);
+      std::exit (EXIT_SUCCESS);
+    } else if (!a.empty () && a.front () == '-') {
+      std::cerr << "Error: unknown option " << a << '\n';
+      return false;
+    } else if (!opts.input.empty ()) {
+      std::cerr << "Error: only one input file may be specified\n";
+      return false;
+    } else {
+      opts.input = a;
+    }
+  }
+  if (opts.input.empty ()) {
+    std::cerr << "Error: no input file\n";
+    return false;
+  }
+  if (opts.start.empty ()) {
+    std::cerr << "Error: no start rule\n";
+    return false;
+  }
+  return true;
+}
+
+/// Converts an ABNF rule name to a C++ identifier.
+std::string identifier (std::string_view const name) {
+  static constexpr std::array<std::string_view, 14> keywords{
+      {"and", "bitand", "bitor", "char", "compl", "default", "delete", "int", "new", "not", "or", "register", "return",
+       "xor"}};
+  auto result = abnf::lower (name);
+  std::replace (result.begin (), result.end (), '-', '_');
+  if (std::find (keywords.begin (), keywords.end (), result) != keywords.end ()) {
+    result += '_';
+  }
+  return result;
+}
+
+/// Writes the members of \p container, \p per_line to a line.
+template <typename Container, typename Function>
+void write_values (std::ostream& os, Container const& container, std::size_t const per_line, Function f) {
+  auto count = std::size_t{0};
+  for (auto const& v : container) {
+    os << (count % per_line == 0 ? "\n    " : " ");
+    f (os, v);
+    os << ',';
+    ++count;
+  }
+  os << '\n';
+}
+
+void write_machine (std::ostream& os, std::string const& id, abnf::nfa const& program, abnf::dfa const& machine) {
+  os << "inline constexpr std::array<uri::automaton::char_set, " << program.sets.size () << "> " << id
+     << "_sets{{";
+  write_values (os, program.sets, 1, [] (std::ostream& o, abnf::char_set const& set) {
+    o << "{{";
+    auto separator = "";
+    for (auto const w : set) {
+      o << separator << "0x" << std::hex << std::setw (16) << std::setfill ('0') << w << std::dec << "U";
+      separator = ", ";
+    }
+    o << "}}";
+  });
+  os << "}};\n";
+
+  os << "inline constexpr std::array<std::uint8_t, 256> " << id << "_classes{{";
+  write_values (os, machine.classes, 16, [] (std::ostream& o, std::uint8_t const v) { o << unsigned{v}; });
+  os << "}};\n";
+
+  os << "inline constexpr std::array<std::uint16_t, " << machine.transitions.size () << "> " << id
+     << "_transitions{{";
+  write_values (os, machine.transitions, machine.num_classes,
+                [] (std::ostream& o, std::uint16_t const v) { o << unsigned{v}; });
+  os << "}};\n";
+
+  os << "inline constexpr std::array<bool, " << machine.accepting.size () << "> " << id << "_accepting{{";
+  write_values (os, machine.accepting, 8, [] (std::ostream& o, bool const v) { o << (v ? "true" : "false"); });
+  os << "}};\n";
+
+  os << "inline constexpr std::array<uri::automaton::instruction, " << program.code.size () << "> " << id
+     << "_code{{";
+  write_values (os, program.code, 4, [] (std::ostream& o, uri::automaton::instruction const& inst) {
+    using uri::automaton::opcode;
+    auto name = "";
+    switch (inst.op) {
+    case opcode::set: name = "set"; break;
+    case opcode::split: name = "split"; break;
+    case opcode::jump: name = "jump"; break;
+    case opcode::open: name = "open"; break;
+    case opcode::close: name = "close"; break;
+    case opcode::match: name = "match"; break;
+    }
+    o << "{opcode::" << name << ", " << inst.arg0 << ", " << inst.arg1 << '}';
+  });
+  os << "}};\n";
+}
+
+void write_header (std::ostream& os, options const& opts, abnf::grammar const& g) {
+  auto guard = "ABNF2CPP_" + identifier (opts.input.stem ().string ()) + "_HPP";
+  std::transform (guard.begin (), guard.end (), guard.begin (), [] (char const c) {
+    auto const u = c >= 'a' && c <= 'z' ? static_cast<char> (c - 'a' + 'A') : c;
+    return (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') ? u : '_';
+  });
+
+  os << "// Generated by abnf2cpp from " << opts.input.filename ().string () << ". Do not edit.\n"
+     << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+     << "#include <array>\n#include <cstddef>\n#include <cstdint>\n#include <string_view>\n\n"
+     << "#include \"uri/automaton.hpp\"\n\n"
+     << "namespace " << opts.name_space << " {\n\n";
+
+  os << "enum class capture : std::size_t {";
+  for (auto const& c : opts.captures) {
+    os << "\n  " << identifier (c) << ',';
+  }
+  os << "\n};\n"
+     << "inline constexpr std::array<std::string_view, " << opts.captures.size () << "> capture_names{{";
+  for (auto const& c : opts.captures) {
+    auto const pos = g.find (abnf::lower (c));
+    os << "\n    \"" << (pos != g.end () ? pos->second.name : c) << "\",";
+  }
+  os << "\n}};\n\n";
+
+  struct machine {
+    std::string id;
+    std::string name;
+    abnf::nfa program;
+    abnf::dfa dfa;
+  };
+  std::vector<machine> machines;
+  for (auto const& start : opts.start) {
+    auto program = abnf::compile (g, start, opts.captures);
+    auto dfa = abnf::determinize (program);
+    machines.push_back ({identifier (start), g.at (abnf::lower (start)).name, std::move (program), std::move (dfa)});
+  }
+
+  os << "namespace details {\n\nusing uri::automaton::opcode;\n\n";
+  for (auto const& m : machines) {
+    write_machine (os, m.id, m.program, m.dfa);
+    os << '\n';
+  }
+  os << "}  // end namespace details\n\n";
+
+  for (auto const& m : machines) {
+    auto const& id = m.id;
+    os << "inline constexpr uri::automaton::dfa " << id << "_dfa{details::" << id << "_classes, " << m.dfa.num_classes
+       << ", details::" << id << "_transitions, details::" << id << "_accepting};\n"
+       << "inline constexpr uri::automaton::program " << id << "_program{details::" << id << "_code, details::" << id
+       << "_sets, " << opts.captures.size () << "};\n\n"
+       << "/// Returns true if \\p input matches the " << m.name << " rule.\n"
+       << "constexpr bool recognize_" << id << " (std::string_view const input) noexcept {\n"
+       << "  return uri::automaton::recognize (" << id << "_dfa, input);\n}\n\n"
+       << "/// If \\p input matches the rule, calls hook(capture, text) for each captured\n"
+       << "/// rule and returns true.\n"
+       << "template <typename Hook> bool parse_" << id << " (std::string_view const input, Hook hook) {\n"
+       << "  return uri::automaton::parse (" << id << "_program, input,\n"
+       << "                                [&hook] (std::size_t const c, std::string_view const text) {\n"
+       << "                                  hook (static_cast<capture> (c), text);\n"
+       << "                                });\n}\n\n";
+  }
+  os << "}  // end namespace " << opts.name_space << "\n\n#endif  // " << guard << '\n';
+}
+
+}  // end anonymous namespace
+
+int main (int argc, char const* argv[]) {
+  int exit_code = EXIT_SUCCESS;
+  try {
+    options opts;
+    if (!parse_options (argc, argv, opts)) {
+      usage (std::cerr, argv[0]);
+      return EXIT_FAILURE;
+    }
+
+    std::ifstream infile{opts.input};
+    if (!infile.is_open ()) {
+      std::cerr << "Error: couldn't open " << opts.input << '\n';
+      return EXIT_FAILURE;
+    }
+    std::stringstream text;
+    text << infile.rdbuf ();
+
+    abnf::grammar g;
+    abnf::parse (text.str (), opts.input.string (), g);
+    abnf::add_core_rules (g);
+
+    // Generate the complete output before writing anything so that an error
+    // does not leave a partial file behind.
+    std::ostringstream out;
+    write_header (out, opts, g);
+    if (opts.output.empty ()) {
+      std::cout << out.str ();
+    } else {
+      std::ofstream outfile{opts.output};
+      if (!outfile.is_open ()) {
+        std::cerr << "Error: couldn't open " << opts.output << '\n';
+        return EXIT_FAILURE;
+      }
+      outfile << out.str ();
+    }
+  } catch (std::exception const& ex) {
+    std::cerr << "Error: " << ex.what () << '\n';
+    exit_code = EXIT_FAILURE;
+  } catch (...) {
+    std::cerr << "An unknown error occurred\n";
+    exit_code = EXIT_FAILURE;
+  }
+  return exit_code;
+}
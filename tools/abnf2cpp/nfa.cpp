@@ -0,0 +1,306 @@
+//===- tools/abnf2cpp/nfa.cpp ---------------------------------------------===//
+//*         __        *
+//*  _ __  / _| __ _  *
+//* | '_ \| |_ / _` | *
+//* | | | |  _| (_| | *
+//* |_| |_|_|  \__,_| *
+//*                   *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include "nfa.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <map>
+
+using uri::automaton::instruction;
+using uri::automaton::opcode;
+
+namespace {
+
+class compiler {
+public:
+  compiler (abnf::grammar const& g, std::vector<std::string> const& captures) : g_{g} {
+    for (auto const& name : captures) {
+      captures_.emplace (abnf::lower (name), static_cast<std::uint16_t> (captures_.size ()));
+    }
+  }
+
+  abnf::nfa run (std::string const& start) {
+    auto const key = abnf::lower (start);
+    auto const pos = g_.find (key);
+    if (pos == g_.end ()) {
+      throw std::runtime_error{"start rule '" + start + "' is not defined"};
+    }
+    this->reference (pos->second, key);
+    this->emit (opcode::match);
+    return std::move (result_);
+  }
+
+private:
+  std::size_t emit (opcode const op, std::size_t const arg0 = 0, std::size_t const arg1 = 0) {
+    if (result_.code.size () >= std::numeric_limits<std::uint16_t>::max ()) {
+      throw std::runtime_error{"the program is too large"};
+    }
+    result_.code.push_back ({op, static_cast<std::uint16_t> (arg0), static_cast<std::uint16_t> (arg1)});
+    return result_.code.size () - 1U;
+  }
+  [[nodiscard]] std::size_t here () const noexcept { return result_.code.size (); }
+  void set_arg0 (std::size_t const pc, std::size_t const arg0) {
+    result_.code[pc].arg0 = static_cast<std::uint16_t> (arg0);
+  }
+  void set_arg1 (std::size_t const pc, std::size_t const arg1) {
+    result_.code[pc].arg1 = static_cast<std::uint16_t> (arg1);
+  }
+
+  std::size_t set_index (abnf::char_set const& set) {
+    auto& sets = result_.sets;
+    auto const pos = std::find (sets.begin (), sets.end (), set);
+    if (pos != sets.end ()) {
+      return static_cast<std::size_t> (pos - sets.begin ());
+    }
+    sets.push_back (set);
+    return sets.size () - 1U;
+  }
+
+  void reference (abnf::rule const& r, std::string const& key) {
+    if (std::find (active_.begin (), active_.end (), key) != active_.end ()) {
+      throw abnf::error{r.file, r.line, "rule '" + r.name + "' is recursive"};
+    }
+    auto const capture = captures_.find (key);
+    if (capture != captures_.end ()) {
+      this->emit (opcode::open, capture->second);
+    }
+    active_.push_back (key);
+    this->generate (*r.definition, r);
+    active_.pop_back ();
+    if (capture != captures_.end ()) {
+      this->emit (opcode::close, capture->second);
+    }
+  }
+
+  void generate (abnf::node const& n, abnf::rule const& owner) {
+    using kind = abnf::node::kind;
+    switch (n.k) {
+    case kind::chars: this->emit (opcode::set, this->set_index (n.set)); break;
+    case kind::concatenation:
+      for (auto const& child : n.children) {
+        this->generate (*child, owner);
+      }
+      break;
+    case kind::alternation: {
+      // split L1, L2; L1: <first>; jump end; L2: split ...; <last>; end:
+      std::vector<std::size_t> jumps;
+      for (auto it = n.children.begin (), last = n.children.end () - 1; it != last; ++it) {
+        auto const split = this->emit (opcode::split);
+        this->set_arg0 (split, this->here ());
+        this->generate (**it, owner);
+        jumps.push_back (this->emit (opcode::jump));
+        this->set_arg1 (split, this->here ());
+      }
+      this->generate (*n.children.back (), owner);
+      for (auto const jump : jumps) {
+        this->set_arg0 (jump, this->here ());
+      }
+    } break;
+    case kind::repetition: {
+      auto const& child = *n.children.front ();
+      for (auto count = 0U; count < n.min; ++count) {
+        this->generate (child, owner);
+      }
+      if (n.max == abnf::node::unbounded) {
+        // loop: split body, end; body: <child>; jump loop; end:
+        auto const loop = this->emit (opcode::split);
+        this->set_arg0 (loop, this->here ());
+        this->generate (child, owner);
+        this->emit (opcode::jump, loop);
+        this->set_arg1 (loop, this->here ());
+      } else {
+        // Each optional instance may skip directly to the end.
+        std::vector<std::size_t> splits;
+        for (auto count = n.min; count < n.max; ++count) {
+          auto const split = this->emit (opcode::split);
+          this->set_arg0 (split, this->here ());
+          splits.push_back (split);
+          this->generate (child, owner);
+        }
+        for (auto const split : splits) {
+          this->set_arg1 (split, this->here ());
+        }
+      }
+    } break;
+    case kind::rule_ref: {
+      auto const key = abnf::lower (n.name);
+      auto const pos = g_.find (key);
+      if (pos == g_.end ()) {
+        throw abnf::error{owner.file, n.line, "rule '" + n.name + "' is not defined"};
+      }
+      this->reference (pos->second, key);
+    } break;
+    }
+  }
+
+  abnf::grammar const& g_;
+  std::map<std::string, std::uint16_t> captures_;
+  std::vector<std::string> active_;
+  abnf::nfa result_;
+};
+
+using state_set = std::vector<std::uint16_t>;
+
+/// Returns the set of set and match instructions which are reachable from
+/// \p seeds without consuming input.
+state_set closure (abnf::nfa const& program, state_set const& seeds, std::vector<bool>& visited) {
+  std::fill (visited.begin (), visited.end (), false);
+  state_set result;
+  auto stack = seeds;
+  while (!stack.empty ()) {
+    auto const pc = stack.back ();
+    stack.pop_back ();
+    if (visited[pc]) {
+      continue;
+    }
+    visited[pc] = true;
+    auto const& inst = program.code[pc];
+    switch (inst.op) {
+    case opcode::set:
+    case opcode::match: result.push_back (pc); break;
+    case opcode::split:
+      stack.push_back (inst.arg1);
+      stack.push_back (inst.arg0);
+      break;
+    case opcode::jump: stack.push_back (inst.arg0); break;
+    case opcode::open:
+    case opcode::close: stack.push_back (static_cast<std::uint16_t> (pc + 1U)); break;
+    }
+  }
+  std::sort (result.begin (), result.end ());
+  return result;
+}
+
+/// Partitions the 256 possible input characters into classes whose members
+/// are indistinguishable by every set in the program.
+std::size_t make_classes (abnf::nfa const& program, std::array<std::uint8_t, 256>& classes,
+                          std::vector<char>& representatives) {
+  std::map<std::vector<bool>, std::uint8_t> signatures;
+  for (auto c = 0U; c < 256U; ++c) {
+    std::vector<bool> signature;
+    signature.reserve (program.sets.size ());
+    for (auto const& set : program.sets) {
+      signature.push_back (uri::automaton::contains (set, static_cast<char> (c)));
+    }
+    auto const [pos, inserted] = signatures.try_emplace (std::move (signature), static_cast<std::uint8_t> (signatures.size ()));
+    if (inserted) {
+      representatives.push_back (static_cast<char> (c));
+    }
+    classes[c] = pos->second;
+  }
+  return signatures.size ();
+}
+
+}  // end anonymous namespace
+
+namespace abnf {
+
+nfa compile (grammar const& g, std::string const& start, std::vector<std::string> const& captures) {
+  return compiler{g, captures}.run (start);
+}
+
+dfa determinize (nfa const& program) {
+  dfa result;
+  std::vector<char> representatives;
+  result.num_classes = make_classes (program, result.classes, representatives);
+  auto const num_classes = result.num_classes;
+
+  // Subset construction.
+  std::vector<bool> visited (program.code.size (), false);
+  std::map<state_set, std::size_t> ids;
+  std::vector<state_set> states;
+  auto const id = [&] (state_set&& s) {
+    auto const [pos, inserted] = ids.try_emplace (s, states.size ());
+    if (inserted) {
+      states.push_back (std::move (s));
+    }
+    return pos->second;
+  };
+  id (state_set{});                                              // The dead state.
+  id (closure (program, state_set{std::uint16_t{0}}, visited));  // The initial state.
+
+  std::vector<std::size_t> transitions;
+  std::vector<bool> accepting;
+  for (auto s = std::size_t{0}; s < states.size (); ++s) {
+    accepting.push_back (std::any_of (states[s].begin (), states[s].end (),
+                                      [&program] (std::uint16_t const pc) {
+                                        return program.code[pc].op == opcode::match;
+                                      }));
+    for (auto k = std::size_t{0}; k < num_classes; ++k) {
+      state_set seeds;
+      for (auto const pc : states[s]) {
+        auto const& inst = program.code[pc];
+        if (inst.op == opcode::set && uri::automaton::contains (program.sets[inst.arg0], representatives[k])) {
+          seeds.push_back (static_cast<std::uint16_t> (pc + 1U));
+        }
+      }
+      // Note that 'states' may be reallocated by id().
+      transitions.push_back (seeds.empty () ? std::size_t{0} : id (closure (program, seeds, visited)));
+    }
+  }
+  auto const num_states = states.size ();
+
+  // Minimization by (Moore's) partition refinement: states are distinguished
+  // by whether they accept and then by the blocks of their successors.
+  std::vector<std::size_t> block (num_states);
+  std::transform (accepting.begin (), accepting.end (), block.begin (),
+                  [] (bool const a) { return static_cast<std::size_t> (a); });
+  for (auto num_blocks = std::size_t{0};;) {
+    std::map<std::vector<std::size_t>, std::size_t> signatures;
+    std::vector<std::size_t> next (num_states);
+    for (auto s = std::size_t{0}; s < num_states; ++s) {
+      std::vector<std::size_t> signature{block[s]};
+      for (auto k = std::size_t{0}; k < num_classes; ++k) {
+        signature.push_back (block[transitions[s * num_classes + k]]);
+      }
+      next[s] = signatures.try_emplace (std::move (signature), signatures.size ()).first->second;
+    }
+    block = std::move (next);
+    if (signatures.size () == num_blocks) {
+      break;
+    }
+    num_blocks = signatures.size ();
+  }
+
+  // Number the blocks so that the dead state is 0 and the initial state is 1.
+  // If the language is empty, the initial state is a copy of the dead state.
+  constexpr auto unassigned = std::numeric_limits<std::size_t>::max ();
+  std::vector<std::size_t> number (num_states, unassigned);
+  number[block[0]] = 0;
+  auto count = std::size_t{2};
+  if (block[1] != block[0]) {
+    number[block[1]] = 1;
+  }
+  for (auto s = std::size_t{0}; s < num_states; ++s) {
+    if (number[block[s]] == unassigned) {
+      number[block[s]] = count++;
+    }
+  }
+  if (count > std::numeric_limits<std::uint16_t>::max ()) {
+    throw std::runtime_error{"the DFA has too many states"};
+  }
+  result.transitions.resize (count * num_classes, 0);
+  result.accepting.resize (count, false);
+  for (auto s = std::size_t{0}; s < num_states; ++s) {
+    auto const n = number[block[s]];
+    result.accepting[n] = accepting[s];
+    for (auto k = std::size_t{0}; k < num_classes; ++k) {
+      result.transitions[n * num_classes + k] =
+          static_cast<std::uint16_t> (number[block[transitions[s * num_classes + k]]]);
+    }
+  }
+  return result;
+}
+
+}  // end namespace abnf
@@ -0,0 +1,55 @@
+//===- tools/abnf2cpp/nfa.hpp -----------------------------*- mode: C++ -*-===//
+//*         __        *
+//*  _ __  / _| __ _  *
+//* | '_ \| |_ / _` | *
+//* | | | |  _| (_| | *
+//* |_| |_|_|  \__,_| *
+//*                   *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#ifndef ABNF2CPP_NFA_HPP
+#define ABNF2CPP_NFA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "abnf.hpp"
+
+namespace abnf {
+
+/// An NFA program in the form expected by uri::automaton::parse().
+struct nfa {
+  std::vector<uri::automaton::instruction> code;
+  std::vector<char_set> sets;
+};
+
+/// Translates a rule (and the rules that it references) into an NFA program
+/// using Thompson's construction. References to the rules named by
+/// \p captures are bracketed by open/close instructions whose argument is the
+/// rule's index in that vector.
+///
+/// Rules that refer to themselves, directly or indirectly, cannot be expressed
+/// by a finite automaton and are reported as an error.
+nfa compile (grammar const& g, std::string const& start, std::vector<std::string> const& captures);
+
+/// The tables describing a DFA in the form expected by uri::automaton::dfa.
+struct dfa {
+  std::array<std::uint8_t, 256> classes{};
+  std::size_t num_classes = 0;
+  std::vector<std::uint16_t> transitions;
+  std::vector<bool> accepting;
+};
+
+/// Builds the minimal DFA which accepts the same language as \p program.
+/// State 0 of the result is the dead state; state 1 is the initial state.
+dfa determinize (nfa const& program);
+
+}  // end namespace abnf
+
+#endif  // ABNF2CPP_NFA_HPP
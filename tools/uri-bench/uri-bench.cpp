@@ -0,0 +1,229 @@
+//===- tools/uri-bench/uri-bench.cpp --------------------------------------===//
+//*             _       _                     _      *
+//*  _   _ _ __(_)     | |__   ___ _ __   ___| |__   *
+//* | | | | '__| |_____| '_ \ / _ \ '_ \ / __| '_ \  *
+//* | |_| | |  | |_____| |_) |  __/ | | | (__| | | | *
+//*  \__,_|_|  |_|     |_.__/ \___|_| |_|\___|_| |_| *
+//*                                                  *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "uri/join_context.hpp"
+#include "uri/lazy_parts.hpp"
+#include "uri/observer.hpp"
+#include "uri/uri.hpp"
+
+// uri-bench measures the time taken to split a corpus of URI references. The
+// references are read one per line from the files named on the command line
+// or, if there are none, a built-in corpus of relative references is used. If
+// the library was built with URI_OBSERVE, the per-production counters are also
+// shown.
+//
+// With --worst-case, the tool instead measures the time taken to split
+// adversarial inputs of increasing length.
+
+namespace {
+
+std::vector<std::string> default_corpus () {
+  return {
+    "../a/b/c?q#f",
+    "/just/a/path",
+    "rel/path/index.html",
+    "./this:that",
+    "g;x=1/../y",
+    "?query=only",
+    "#fragment-only",
+    "//example.com/a/b/c/d/e/index.html?query=value&x=1#frag",
+    "//user@example.com:8080/path",
+    "//192.168.1.1/status",
+    "//[2001:db8:85a3::8a2e:370:7334]/a/b?x=1",
+    "//[::ffff:192.168.1.1]:8080/",
+    "//[1:2:3:4:5:6:7:8]/p",
+    "//[fe80::1]/index.html",
+    "//[v7.future]/",
+  };
+}
+
+using split_function = std::function<bool (std::string_view)>;
+
+struct benchmark {
+  char const* name;
+  split_function function;
+};
+
+/// Calls \p function for every member of \p corpus, repeating until at least
+/// \p min_time has elapsed. Returns the mean time per reference.
+std::chrono::duration<double, std::nano> measure (std::vector<std::string> const& corpus,
+                                                  split_function const& function,
+                                                  std::chrono::duration<double> const min_time) {
+  using clock = std::chrono::steady_clock;
+  auto count = std::size_t{0};
+  auto const start = clock::now ();
+  auto elapsed = clock::duration{0};
+  do {
+    for (auto const& ref : corpus) {
+      if (!function (ref)) {
+        std::cerr << "Error: could not split " << std::quoted (ref) << '\n';
+        std::exit (EXIT_FAILURE);
+      }
+    }
+    count += corpus.size ();
+    elapsed = clock::now () - start;
+  } while (elapsed < min_time);
+  return std::chrono::duration<double, std::nano>{elapsed} / static_cast<double> (count);
+}
+
+/// Inputs which force the grammar to backtrack. Each function returns an input
+/// of approximately \p length characters.
+struct adversary {
+  char const* name;
+  std::string (*make) (std::size_t length);
+};
+
+std::array<adversary, 4> const adversaries{{
+  // userinfo consumes the run and fails to find "@". The run is then matched
+  // again as reg-name.
+  {"//a...a[", [] (std::size_t const length) { return "//" + std::string (length, 'a') + "["; }},
+  // Each of the IPv6address alternatives tries the h16 ":" run.
+  {"//[1:...:1]",
+   [] (std::size_t const length) {
+     std::string result = "//[";
+     while (result.length () < length) {
+       result += "1:";
+     }
+     return result + "1]";
+   }},
+  {"//[::...:]", [] (std::size_t const length) { return "//[" + std::string (length, ':') + "]"; }},
+  {"//[::1]/a...a", [] (std::size_t const length) { return "//[::1]/" + std::string (length, 'a'); }},
+}};
+
+/// Shows the time per input character taken by split_reference() with the
+/// default budget for adversarial inputs of increasing length. The time per
+/// character should be independent of the length.
+void worst_case () {
+  using clock = std::chrono::steady_clock;
+  std::cout << std::left << std::setw (16) << "input" << std::right << std::setw (10) << "length" << std::setw (12)
+            << "ns/char" << '\n';
+  for (auto const& [name, make] : adversaries) {
+    for (auto length = std::size_t{256}; length <= std::size_t{256} * 1024; length *= 4) {
+      auto const input = make (length);
+      auto count = std::size_t{0};
+      auto const start = clock::now ();
+      auto elapsed = clock::duration{0};
+      do {
+        auto const r = uri::split_reference (input, uri::split_budget{});
+        (void)r;
+        ++count;
+        elapsed = clock::now () - start;
+      } while (elapsed < std::chrono::milliseconds{100});
+      auto const ns = std::chrono::duration<double, std::nano>{elapsed}.count () / static_cast<double> (count);
+      std::cout << std::left << std::setw (16) << name << std::right << std::setw (10) << input.length ()
+                << std::setw (12) << std::fixed << std::setprecision (2) << ns / static_cast<double> (input.length ())
+                << '\n';
+    }
+  }
+}
+
+bool read_corpus (std::istream& is, std::vector<std::string>& corpus) {
+  std::string line;
+  while (std::getline (is, line)) {
+    corpus.push_back (line);
+  }
+  return !is.bad ();
+}
+
+}  // end anonymous namespace
+
+int main (int argc, char const* argv[]) {
+  int exit_code = EXIT_SUCCESS;
+  try {
+    if (argc == 2 && argv[1] == std::string_view{"--worst-case"}) {
+      worst_case ();
+      return EXIT_SUCCESS;
+    }
+
+    std::vector<std::string> corpus;
+    for (int arg = 1; arg < argc; ++arg) {
+      std::filesystem::path const p = argv[arg];
+      std::ifstream infile{p};
+      if (!infile.is_open () || !read_corpus (infile, corpus)) {
+        std::cerr << "Error: couldn't read " << p << '\n';
+        return EXIT_FAILURE;
+      }
+    }
+    if (corpus.empty ()) {
+      corpus = default_corpus ();
+    }
+
+    // The corpus members are also resolved as the links of a single page.
+    static constexpr auto page = std::string_view{"http://example.com/a/b/c/d;p?q"};
+    auto const page_context = uri::join_context::make (page);
+    uri::parts target;
+
+    std::vector<benchmark> const benchmarks{
+      {"split_reference", [] (std::string_view const s) { return uri::split_reference (s).has_value (); }},
+      // Checks only the host as a host-based router would.
+      {"split_reference_lazy (host)",
+       [] (std::string_view const s) {
+         auto const p = uri::split_reference_lazy (s);
+         return p.has_value () && p->valid (uri::parts_field::host);
+       }},
+      {"split_reference<scheme|host>",
+       [] (std::string_view const s) {
+         return uri::split_reference<uri::field_mask::scheme | uri::field_mask::host> (s).has_value ();
+       }},
+      {"join", [] (std::string_view const s) { return uri::join (page, s).has_value (); }},
+      {"join_context", [&] (std::string_view const s) { return page_context->join (s, target); }},
+      {"split_reference_rules",
+       [] (std::string_view const s) { return uri::details::split_reference_rules (s).has_value (); }},
+      {"split_reference_rules (memoized)",
+       [] (std::string_view const s) {
+         return uri::details::split_reference_rules (s, uri::grammar::memoization::on).has_value ();
+       }},
+    };
+    auto bytes = std::size_t{0};
+    for (auto const& ref : corpus) {
+      bytes += ref.length ();
+    }
+    auto const mean_length = static_cast<double> (bytes) / static_cast<double> (corpus.size ());
+    for (auto const& [name, function] : benchmarks) {
+      auto const t = measure (corpus, function, std::chrono::milliseconds{250});
+      std::cout << std::left << std::setw (36) << name << std::right << std::fixed << std::setprecision (1)
+                << std::setw (10) << t.count () << " ns/ref " << std::setw (10) << mean_length / t.count () * 1000.0
+                << " MB/s\n";
+    }
+
+    if constexpr (uri::observe_productions) {
+      // Report the work done by each grammar production for one pass over
+      // the corpus.
+      uri::production_counters counters;
+      auto* const prev = uri::set_production_observer (&counters);
+      for (auto const& ref : corpus) {
+        (void)uri::details::split_reference_rules (ref);
+      }
+      uri::set_production_observer (prev);
+      std::cout << '\n' << counters;
+    }
+  } catch (std::exception const& ex) {
+    std::cerr << "Error: " << ex.what () << '\n';
+    exit_code = EXIT_FAILURE;
+  } catch (...) {
+    std::cerr << "An unknown error occurred\n";
+    exit_code = EXIT_FAILURE;
+  }
+  return exit_code;
+}
@@ -0,0 +1,144 @@
+//===- unittests/uri/test_archive.cpp -------------------------------------===//
+//*  _            _                    _     _            *
+//* | |_ ___  ___| |_    __ _ _ __ ___| |__ (_)_   _____  *
+//* | __/ _ \/ __| __|  / _` | '__/ __| '_ \| \ \ / / _ \ *
+//* | ||  __/\__ \ |_  | (_| | | | (__| | | | |\ V /  __/ *
+//*  \__\___||___/\__|  \__,_|_|  \___|_| |_|_| \_/ \___| *
+//*                                                       *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "uri/archive.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+std::vector<std::byte> to_bytes (uri::archive_writer const& writer) {
+  std::ostringstream os;
+  writer.write (os);
+  auto const str = os.str ();
+  auto const* const first = reinterpret_cast<std::byte const*> (str.data ());
+  return {first, first + str.size ()};
+}
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (Archive, RoundTrip) {
+  static constexpr std::array inputs{
+      "http://user@example.com:8080/a/b/c?q=1#frag"sv,
+      ""sv,
+      "/"sv,
+      "//"sv,
+      "?#"sv,
+      "a/b:c"sv,
+      "//[::1]:80/a/b/c/d/e/f/g/h/i/j"sv,
+      "mailto:John.Doe@example.com"sv,
+  };
+  uri::archive_writer writer;
+  std::vector<uri::parts> expected;
+  for (auto const input : inputs) {
+    auto const p = uri::split_reference (input);
+    ASSERT_TRUE (p.has_value ()) << input;
+    EXPECT_TRUE (writer.push_back (input, *p));
+    expected.push_back (*p);
+  }
+  EXPECT_EQ (writer.size (), inputs.size ());
+
+  auto const bytes = to_bytes (writer);
+  auto const opened = uri::archive::open (bytes);
+  ASSERT_TRUE (std::holds_alternative<uri::archive> (opened));
+  auto const& a = std::get<uri::archive> (opened);
+  ASSERT_EQ (a.size (), inputs.size ());
+  auto const* const text_begin = reinterpret_cast<char const*> (bytes.data ());
+  auto const* const text_end = text_begin + bytes.size ();
+  for (auto index = std::size_t{0}; index < inputs.size (); ++index) {
+    EXPECT_EQ (a.source (index), inputs[index]);
+    auto const p = a.at (index);
+    ASSERT_TRUE (p.has_value ());
+    EXPECT_EQ (*p, expected[index]) << inputs[index];
+    EXPECT_EQ (p->path.absolute, expected[index].path.absolute);
+    // The strings refer directly to the archive's bytes.
+    if (p->scheme) {
+      EXPECT_GE (p->scheme->data (), text_begin);
+      EXPECT_LE (p->scheme->data () + p->scheme->size (), text_end);
+    }
+  }
+}
+// NOLINTNEXTLINE
+TEST (Archive, Empty) {
+  auto const bytes = to_bytes (uri::archive_writer{});
+  EXPECT_EQ (bytes.size (), uri::details::archive_layout::header_size);
+  auto const opened = uri::archive::open (bytes);
+  ASSERT_TRUE (std::holds_alternative<uri::archive> (opened));
+  EXPECT_TRUE (std::get<uri::archive> (opened).empty ());
+}
+// NOLINTNEXTLINE
+TEST (Archive, IndexOutOfRange) {
+  uri::archive_writer writer;
+  auto const p = uri::split ("http://example.com/");
+  ASSERT_TRUE (p.has_value ());
+  EXPECT_TRUE (writer.push_back ("http://example.com/", *p));
+  auto const bytes = to_bytes (writer);
+  auto const opened = uri::archive::open (bytes);
+  ASSERT_TRUE (std::holds_alternative<uri::archive> (opened));
+  auto const& a = std::get<uri::archive> (opened);
+  EXPECT_EQ (a.source (1), std::nullopt);
+  EXPECT_EQ (a.at (1), std::nullopt);
+  EXPECT_EQ (a.bounds (1), uri::compact_parts{});
+}
+// NOLINTNEXTLINE
+TEST (Archive, PartsOutsideSource) {
+  uri::archive_writer writer;
+  auto const p = uri::split ("http://example.com/");
+  ASSERT_TRUE (p.has_value ());
+  EXPECT_FALSE (writer.push_back ("http://example.org/", *p));
+  EXPECT_TRUE (writer.empty ());
+}
+// NOLINTNEXTLINE
+TEST (Archive, BadHeader) {
+  uri::archive_writer writer;
+  auto const input = "http://example.com/"sv;
+  writer.push_back (input, *uri::split (input));
+  auto const bytes = to_bytes (writer);
+  auto const error = [] (std::span<std::byte const> b) {
+    auto const opened = uri::archive::open (b);
+    return std::holds_alternative<std::error_code> (opened) ? std::get<std::error_code> (opened) : std::error_code{};
+  };
+
+  EXPECT_EQ (error (std::span{bytes}.first (10)), make_error_code (uri::archive_error::truncated));
+  EXPECT_EQ (error (std::span{bytes}.first (bytes.size () - 1)), make_error_code (uri::archive_error::truncated));
+
+  auto bad_magic = bytes;
+  bad_magic[0] = std::byte{'X'};
+  EXPECT_EQ (error (bad_magic), make_error_code (uri::archive_error::bad_magic));
+
+  auto bad_version = bytes;
+  bad_version[8] = std::byte{2};
+  EXPECT_EQ (error (bad_version), make_error_code (uri::archive_error::bad_version));
+  EXPECT_EQ (make_error_code (uri::archive_error::truncated).message (), "archive is truncated");
+}
+// NOLINTNEXTLINE
+TEST (Archive, CorruptRecord) {
+  uri::archive_writer writer;
+  auto const input = "http://example.com/"sv;
+  writer.push_back (input, *uri::split (input));
+  auto bytes = to_bytes (writer);
+  // Make the host's length extend beyond the end of the entry's text.
+  auto const host_length = uri::details::archive_layout::header_size + 16 + 2 * 8 + 4;
+  bytes[host_length] = std::byte{0xFF};
+  auto const opened = uri::archive::open (bytes);
+  ASSERT_TRUE (std::holds_alternative<uri::archive> (opened));
+  EXPECT_FALSE (std::get<uri::archive> (opened).at (0).has_value ());
+}
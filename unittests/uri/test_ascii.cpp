@@ -0,0 +1,70 @@
+//===- unittests/uri/test_ascii.cpp ---------------------------------------===//
+//*  _            _                    _ _  *
+//* | |_ ___  ___| |_    __ _ ___  ___(_|_) *
+//* | __/ _ \/ __| __|  / _` / __|/ __| | | *
+//* | ||  __/\__ \ |_  | (_| \__ \ (__| | | *
+//*  \__\___||___/\__|  \__,_|___/\___|_|_| *
+//*                                         *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gtest/gtest.h>
+
+#include <string_view>
+
+#include "uri/ascii.hpp"
+
+namespace {
+
+using namespace std::string_view_literals;
+
+constexpr auto lower_chars = "abcdefghijklmnopqrstuvwxyz"sv;
+constexpr auto upper_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"sv;
+constexpr auto digit_chars = "0123456789"sv;
+constexpr auto sub_delim_chars = "!$&'()*+,;="sv;
+constexpr auto unreserved_extra = "-._~"sv;
+
+bool contains (std::string_view const str, char const c) {
+  return str.find (c) != std::string_view::npos;
+}
+
+static_assert (uri::ascii::is_alpha ('q'));
+static_assert (!uri::ascii::is_alpha ('\xE9'));
+static_assert (uri::ascii::to_lower ('Q') == 'q');
+static_assert (uri::ascii::to_lower ('\xC9') == '\xC9');
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (Ascii, Classes) {
+  using namespace uri::ascii;
+  for (auto v = 0U; v < 256U; ++v) {
+    auto const c = static_cast<char> (v);
+    bool const is_alpha_c = contains (lower_chars, c) || contains (upper_chars, c);
+    bool const is_digit_c = contains (digit_chars, c);
+    bool const is_unreserved_c = is_alpha_c || is_digit_c || contains (unreserved_extra, c);
+    bool const is_sub_delim_c = contains (sub_delim_chars, c);
+    bool const is_pchar_c = is_unreserved_c || is_sub_delim_c || c == ':' || c == '@';
+
+    EXPECT_EQ (is_alpha (c), is_alpha_c) << v;
+    EXPECT_EQ (is_digit (c), is_digit_c) << v;
+    EXPECT_EQ (is_hexdig (c), is_digit_c || contains ("abcdefABCDEF", c)) << v;
+    EXPECT_EQ (is_sub_delim (c), is_sub_delim_c) << v;
+    EXPECT_EQ (is_unreserved (c), is_unreserved_c) << v;
+    EXPECT_EQ (is (c, scheme), is_alpha_c || is_digit_c || contains ("+-.", c)) << v;
+    EXPECT_EQ (is (c, reg_name), is_unreserved_c || is_sub_delim_c) << v;
+    EXPECT_EQ (is (c, userinfo), is_unreserved_c || is_sub_delim_c || c == ':') << v;
+    EXPECT_EQ (is (c, pchar), is_pchar_c) << v;
+    EXPECT_EQ (is (c, query), is_pchar_c || c == '/' || c == '?') << v;
+  }
+}
+// NOLINTNEXTLINE
+TEST (Ascii, ToLower) {
+  for (auto v = 0U; v < 256U; ++v) {
+    auto const c = static_cast<char> (v);
+    auto const pos = upper_chars.find (c);
+    EXPECT_EQ (uri::ascii::to_lower (c), pos == std::string_view::npos ? c : lower_chars[pos]) << v;
+  }
+}
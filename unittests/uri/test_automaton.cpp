@@ -0,0 +1,183 @@
+//===- unittests/uri/test_automaton.cpp -----------------------------------===//
+//*  _            _                 _                        _               *
+//* | |_ ___  ___| |_    __ _ _   _| |_ ___  _ __ ___   __ _| |_ ___  _ __   *
+//* | __/ _ \/ __| __|  / _` | | | | __/ _ \| '_ ` _ \ / _` | __/ _ \| '_ \  *
+//* | ||  __/\__ \ |_  | (_| | |_| | || (_) | | | | | | (_| | || (_) | | | | *
+//*  \__\___||___/\__|  \__,_|\__,_|\__\___/|_| |_| |_|\__,_|\__\___/|_| |_| *
+//*                                                                          *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "uri/automaton.hpp"
+#include "uri/uri.hpp"
+// The URI recognizer generated from systemtests/uri.abnf by abnf2cpp.
+#include "uri_abnf.hpp"
+
+using testing::ElementsAre;
+using testing::Pair;
+using namespace std::string_view_literals;
+
+namespace {
+
+using capture = uri::generated::capture;
+
+// URI references on which the generated recognizer and the library agree.
+constexpr std::array corpus{
+    ""sv,
+    "/foo///bar"sv,
+    "C://[::A:eE5c]:2194/&///@//:_/%aB//.////#"sv,
+    "P-.:/?/?"sv,
+    "L:%Cf#%dD/?H"sv,
+    "E07:/8=-~%bF//%36////'/%16N%78//)/%53/;?*!"sv,
+    "zR:d/M/kx/s/GTl///SgA/?#"sv,
+    "P://=:_%bb%Cf%2F-8;~@230.109.31.250#."sv,
+    "N://@=i%bD%Cb&*%Ea)%CE//:%cA//#?//"sv,
+    "T.-://:@[VD.~]:?/@#"sv,
+    "rC://3.76.206.5:8966?/"sv,
+    "oNP:///::"sv,
+    "B://.@[AC::1:6DEb:14.97.229.249]:?/#??~("sv,
+    "Z5://@[9:BB:8:DAc:BbAA:E:a::]?#@$"sv,
+    "A://[vA5.+:=.p~=)=&_;-=7)(.;]:768295/+"sv,
+    "http://[2001:db8:85a3::8a2e:370:7334]/a/b?x=1"sv,
+    "//[::ffff:192.168.1.1]:8080/"sv,
+    "//user@example.com:8080/path"sv,
+    "../a/b/c?q#f"sv,
+    "rel/path/index.html"sv,
+    "./this:that"sv,
+    "?query=only"sv,
+    "#fragment-only"sv,
+    "mailto:John.Doe@example.com"sv,
+    "urn:oasis:names:specification:docbook:dtd:xml:4.1.2"sv,
+};
+
+// Strings which are not URI references.
+constexpr std::array invalid{
+    "http://a b/"sv, "%zz"sv, "a:b#c#d"sv, "//[::1/"sv, "//[1:2:3:4:5:6:7:8:9]/"sv, ":x"sv, "//host:port/"sv,
+};
+
+using captures = std::vector<std::pair<capture, std::string>>;
+
+std::optional<captures> parse_reference (std::string_view const input) {
+  captures result;
+  if (!uri::generated::parse_uri_reference (
+          input, [&result] (capture const c, std::string_view const text) { result.emplace_back (c, text); })) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+std::optional<std::string> find (captures const& cs, std::initializer_list<capture> const kinds) {
+  for (auto const& [c, text] : cs) {
+    if (std::find (kinds.begin (), kinds.end (), c) != kinds.end ()) {
+      return text;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (Automaton, RecognizeAgreesWithSplit) {
+  for (auto const str : corpus) {
+    SCOPED_TRACE (str);
+    EXPECT_TRUE (uri::generated::recognize_uri_reference (str));
+    EXPECT_EQ (uri::generated::recognize_uri (str), uri::split (str).has_value ());
+  }
+  for (auto const str : invalid) {
+    SCOPED_TRACE (str);
+    EXPECT_FALSE (uri::split_reference (str).has_value ());
+    EXPECT_FALSE (uri::generated::recognize_uri_reference (str));
+    EXPECT_FALSE (parse_reference (str).has_value ());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST (Automaton, CapturesAgreeWithSplit) {
+  for (auto const str : corpus) {
+    SCOPED_TRACE (str);
+    auto const parts = uri::split_reference (str);
+    ASSERT_TRUE (parts);
+    auto const cs = parse_reference (str);
+    ASSERT_TRUE (cs);
+
+    auto const opt = [] (std::optional<std::string_view> const& sv) {
+      return sv ? std::optional<std::string>{*sv} : std::nullopt;
+    };
+    EXPECT_EQ (find (*cs, {capture::scheme}), opt (parts->scheme));
+    EXPECT_EQ (find (*cs, {capture::query}), opt (parts->query));
+    EXPECT_EQ (find (*cs, {capture::fragment}), opt (parts->fragment));
+    auto const host = find (*cs, {capture::host});
+    EXPECT_EQ (host.has_value (), parts->authority.has_value ());
+    if (parts->authority) {
+      EXPECT_EQ (host, parts->authority->host);
+      EXPECT_EQ (find (*cs, {capture::userinfo}), opt (parts->authority->userinfo));
+      EXPECT_EQ (find (*cs, {capture::port}), opt (parts->authority->port));
+    }
+    EXPECT_EQ (find (*cs, {capture::path_abempty, capture::path_absolute, capture::path_noscheme,
+                           capture::path_rootless, capture::path_empty}),
+               static_cast<std::string> (parts->path));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST (Automaton, CaptureOrder) {
+  auto const cs = parse_reference ("s://u@h:1/p?q#f");
+  ASSERT_TRUE (cs);
+  EXPECT_THAT (*cs, ElementsAre (Pair (capture::scheme, "s"), Pair (capture::userinfo, "u"), Pair (capture::host, "h"),
+                                 Pair (capture::port, "1"), Pair (capture::path_abempty, "/p"),
+                                 Pair (capture::query, "q"), Pair (capture::fragment, "f")));
+  EXPECT_EQ (uri::generated::capture_names[static_cast<std::size_t> (capture::path_abempty)], "path-abempty");
+}
+
+// NOLINTNEXTLINE
+TEST (Automaton, AlternativesAreNotCommitted) {
+  // "1.2.3.4" is a valid IPv4address but the host must then be followed by
+  // ":", "/", "?", "#", or the end of the input. The automaton abandons the
+  // IPv4address alternative and matches the host as a reg-name instead.
+  static_assert (uri::generated::recognize_uri ("http://1.2.3.4x/"));
+  auto const cs = parse_reference ("http://1.2.3.4x/");
+  ASSERT_TRUE (cs);
+  EXPECT_EQ (find (*cs, {capture::host}), "1.2.3.4x");
+}
+
+// NOLINTNEXTLINE
+TEST (Automaton, HandWrittenProgram) {
+  // A program for the expression (a*)b where the parenthesized group is
+  // capture 0.
+  using uri::automaton::opcode;
+  static constexpr std::array<uri::automaton::char_set, 2> sets{{
+      {{0, std::uint64_t{1} << ('a' - 64), 0, 0}},
+      {{0, std::uint64_t{1} << ('b' - 64), 0, 0}},
+  }};
+  static constexpr std::array<uri::automaton::instruction, 7> code{{
+      {opcode::open, 0, 0},
+      {opcode::split, 2, 4},
+      {opcode::set, 0, 0},
+      {opcode::jump, 1, 0},
+      {opcode::close, 0, 0},
+      {opcode::set, 1, 0},
+      {opcode::match, 0, 0},
+  }};
+  uri::automaton::program const prog{code, sets, 1};
+  std::vector<std::string_view> texts;
+  auto const hook = [&texts] (std::size_t const c, std::string_view const text) {
+    EXPECT_EQ (c, 0U);
+    texts.push_back (text);
+  };
+  EXPECT_TRUE (uri::automaton::parse (prog, "aaab", hook));
+  EXPECT_TRUE (uri::automaton::parse (prog, "b", hook));
+  EXPECT_FALSE (uri::automaton::parse (prog, "aba", hook));
+  EXPECT_THAT (texts, ElementsAre ("aaa", ""));
+}
@@ -0,0 +1,125 @@
+//===- unittests/uri/test_compact_parts.cpp -------------------------------===//
+//*                                       _                      _        *
+//*   ___ ___  _ __ ___  _ __   __ _  ___| |_   _ __   __ _ _ __| |_ ___  *
+//*  / __/ _ \| '_ ` _ \| '_ \ / _` |/ __| __| | '_ \ / _` | '__| __/ __| *
+//* | (_| (_) | | | | | | |_) | (_| | (__| |_  | |_) | (_| | |  | |_\__ \ *
+//*  \___\___/|_| |_| |_| .__/ \__,_|\___|\__| | .__/ \__,_|_|   \__|___/ *
+//*                     |_|                    |_|                        *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "uri/compact_parts.hpp"
+#include "uri/uri.hpp"
+
+using namespace std::string_view_literals;
+using testing::ElementsAre;
+
+// NOLINTNEXTLINE
+TEST (CompactParts, Size) {
+  static_assert (sizeof (uri::compact_parts) <= 64U);
+  static_assert (sizeof (uri::compact_parts) * 2U < sizeof (uri::parts));
+}
+// NOLINTNEXTLINE
+TEST (CompactParts, RoundTrip) {
+  static constexpr std::array inputs{
+      ""sv,
+      "/"sv,
+      "a"sv,
+      "a/"sv,
+      "//"sv,
+      "?"sv,
+      "#"sv,
+      "http://user@example.com:8080/a/b/c?q=1#frag"sv,
+      "http://example.com"sv,
+      "http://example.com/"sv,
+      "http://example.com//a//"sv,
+      "C://[::A:eE5c]:2194/&///@//:_/%aB//.////#"sv,
+      "mailto:John.Doe@example.com"sv,
+      "../a/b/c?q#f"sv,
+      "a:?"sv,
+  };
+  for (auto const input : inputs) {
+    SCOPED_TRACE (input);
+    auto const p = uri::split_reference (input);
+    ASSERT_TRUE (p);
+    auto const c = uri::compact (*p, input);
+    ASSERT_TRUE (c);
+    auto const q = uri::expand (*c, input);
+    EXPECT_EQ (q, *p);
+    EXPECT_EQ (q.path.absolute, p->path.absolute);
+    EXPECT_EQ (q.path.segments, p->path.segments);
+  }
+}
+// NOLINTNEXTLINE
+TEST (CompactParts, Fields) {
+  std::string const input = "http://user@example.com:8080/a/b?#f";
+  auto const p = uri::split (input);
+  ASSERT_TRUE (p);
+  auto const c = uri::compact (*p, input);
+  ASSERT_TRUE (c);
+  EXPECT_EQ (c->scheme.view (input), "http");
+  EXPECT_TRUE (c->has_authority ());
+  EXPECT_EQ (c->userinfo.view (input), "user");
+  EXPECT_EQ (c->host.view (input), "example.com");
+  EXPECT_EQ (c->port.view (input), "8080");
+  EXPECT_TRUE (c->absolute);
+  EXPECT_EQ (c->path.view (input), "a/b");
+  // An empty query is distinct from an absent one.
+  EXPECT_EQ (c->query.view (input), "");
+  EXPECT_EQ (c->fragment.view (input), "f");
+}
+// NOLINTNEXTLINE
+TEST (CompactParts, AbsentFields) {
+  std::string const input = "a/b";
+  auto const p = uri::split_reference (input);
+  ASSERT_TRUE (p);
+  auto const c = uri::compact (*p, input);
+  ASSERT_TRUE (c);
+  EXPECT_FALSE (c->scheme.has_value ());
+  EXPECT_FALSE (c->has_authority ());
+  EXPECT_FALSE (c->userinfo.has_value ());
+  EXPECT_FALSE (c->port.has_value ());
+  EXPECT_FALSE (c->query.has_value ());
+  EXPECT_FALSE (c->fragment.has_value ());
+  EXPECT_EQ (c->query.view (input), std::nullopt);
+}
+// NOLINTNEXTLINE
+TEST (CompactParts, OutsideSource) {
+  std::string const input = "http://example.com/";
+  auto p = uri::split (input);
+  ASSERT_TRUE (p);
+  std::string const other = "other";
+  p->query = other;
+  EXPECT_FALSE (uri::compact (*p, input));
+  // Empty strings do not need to refer to the source.
+  p->query = ""sv;
+  EXPECT_TRUE (uri::compact (*p, input));
+}
+// NOLINTNEXTLINE
+TEST (CompactParts, NonContiguousSegments) {
+  std::string const input = "/a/./b";
+  auto p = uri::split_reference (input);
+  ASSERT_TRUE (p);
+  EXPECT_TRUE (uri::compact (*p, input));
+  p->path.remove_dot_segments ();
+  ASSERT_THAT (p->path.segments, ElementsAre ("a", "b"));
+  EXPECT_FALSE (uri::compact (*p, input));
+}
+// NOLINTNEXTLINE
+TEST (CompactParts, AbsoluteWithoutSegments) {
+  uri::parts p;
+  p.path.absolute = true;
+  auto const c = uri::compact (p, ""sv);
+  ASSERT_TRUE (c);
+  auto const q = uri::expand (*c, ""sv);
+  EXPECT_TRUE (q.path.absolute);
+  EXPECT_TRUE (q.path.segments.empty ());
+}
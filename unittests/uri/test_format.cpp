@@ -0,0 +1,150 @@
+//===- unittests/uri/test_format.cpp --------------------------------------===//
+//*  _            _      __                            _    *
+//* | |_ ___  ___| |_   / _| ___  _ __ _ __ ___   __ _| |_  *
+//* | __/ _ \/ __| __| | |_ / _ \| '__| '_ ` _ \ / _` | __| *
+//* | ||  __/\__ \ |_  |  _| (_) | |  | | | | | | (_| | |_  *
+//*  \__\___||___/\__| |_|  \___/|_|  |_| |_| |_|\__,_|\__| *
+//*                                                         *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <iterator>
+#include <string>
+
+#include "uri/format.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+uri::parts split (std::string_view const s) {
+  auto p = uri::split_reference (s);
+  EXPECT_TRUE (p.has_value ()) << s;
+  return p.value_or (uri::parts{});
+}
+
+std::string compose (uri::parts const& p, uri::field_mask const fields) {
+  std::string result;
+  uri::compose_to (p, fields, std::back_inserter (result));
+  return result;
+}
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (ComposeFields, All) {
+  for (auto const s : {""sv, "a:"sv, "//h"sv, "a/b"sv, "http://u@h:80/a/b?q#f"sv, "//h:"sv, "?#"sv}) {
+    EXPECT_EQ (compose (split (s), uri::field_mask::all), s);
+  }
+}
+// NOLINTNEXTLINE
+TEST (ComposeFields, Origin) {
+  auto const p = split ("https://user@example.com:8080/a/b?q=1#top");
+  EXPECT_EQ (compose (p, uri::field_mask::scheme | uri::field_mask::host | uri::field_mask::port),
+             "https://example.com:8080");
+  EXPECT_EQ (compose (p, uri::field_mask::authority), "//user@example.com:8080");
+  EXPECT_EQ (compose (p, uri::field_mask::host), "//example.com");
+}
+// NOLINTNEXTLINE
+TEST (ComposeFields, PathAndQuery) {
+  auto const p = split ("https://example.com/a/b?q=1#top");
+  EXPECT_EQ (compose (p, uri::field_mask::path | uri::field_mask::query), "/a/b?q=1");
+  EXPECT_EQ (compose (p, uri::field_mask::fragment), "#top");
+  EXPECT_EQ (compose (p, uri::field_mask::none), "");
+}
+// NOLINTNEXTLINE
+TEST (ComposeFields, RootlessPathWithAuthority) {
+  uri::parts p;
+  p.authority.emplace ();
+  p.authority->host = "h";
+  p.path.segments.emplace_back ("a");
+  // The "/" which separates the authority from a rootless path is written
+  // only with the authority.
+  EXPECT_EQ (compose (p, uri::field_mask::all), "//h/a");
+  EXPECT_EQ (compose (p, uri::field_mask::path), "a");
+}
+
+// NOLINTNEXTLINE
+TEST (FormatFields, Letters) {
+  using uri::field_mask;
+  using uri::details::format_fields;
+  EXPECT_EQ (format_fields ("", field_mask::all), field_mask::all);
+  EXPECT_EQ (format_fields ("", field_mask::authority), field_mask::authority);
+  EXPECT_EQ (format_fields ("o", field_mask::all), field_mask::scheme | field_mask::host | field_mask::port);
+  EXPECT_EQ (format_fields ("pq", field_mask::all), field_mask::path | field_mask::query);
+  EXPECT_EQ (format_fields ("a", field_mask::all), field_mask::authority);
+  EXPECT_EQ (format_fields ("sf", field_mask::all), field_mask::scheme | field_mask::fragment);
+  EXPECT_EQ (format_fields ("hn", field_mask::authority), field_mask::host | field_mask::port);
+}
+// NOLINTNEXTLINE
+TEST (FormatFields, Invalid) {
+  using uri::field_mask;
+  using uri::details::format_fields;
+  EXPECT_EQ (format_fields ("x", field_mask::all), std::nullopt);
+  EXPECT_EQ (format_fields ("p?", field_mask::all), std::nullopt);
+  // Letters which name components outside the allowed set are rejected.
+  EXPECT_EQ (format_fields ("p", field_mask::authority), std::nullopt);
+  EXPECT_EQ (format_fields ("o", field_mask::authority), std::nullopt);
+}
+
+#if URI_HAVE_FORMAT
+// NOLINTNEXTLINE
+TEST (Format, Parts) {
+  auto const p = split ("https://user@example.com:8080/a/b?q=1#top");
+  EXPECT_EQ (std::format ("{}", p), "https://user@example.com:8080/a/b?q=1#top");
+  EXPECT_EQ (std::format ("{:o}", p), "https://example.com:8080");
+  EXPECT_EQ (std::format ("{:pq}", p), "/a/b?q=1");
+  EXPECT_EQ (std::format ("<{:s}|{:f}>", p, p), "<https:|#top>");
+}
+// NOLINTNEXTLINE
+TEST (Format, Authority) {
+  auto const p = split ("//user@example.com:8080");
+  ASSERT_TRUE (p.authority.has_value ());
+  EXPECT_EQ (std::format ("{}", *p.authority), "user@example.com:8080");
+  EXPECT_EQ (std::format ("{:h}", *p.authority), "example.com");
+}
+// NOLINTNEXTLINE
+TEST (Format, Path) {
+  auto const p = split ("/a/b/");
+  EXPECT_EQ (std::format ("{}", p.path), "/a/b/");
+}
+// NOLINTNEXTLINE
+TEST (Format, InvalidSpecification) {
+  auto const p = split ("/a");
+  std::string_view const spec = "{:x}";
+  EXPECT_THROW ((void)std::vformat (spec, std::make_format_args (p)), std::format_error);
+}
+#endif  // URI_HAVE_FORMAT
+
+#if URI_HAVE_FMT
+// NOLINTNEXTLINE
+TEST (FmtFormat, Parts) {
+  auto const p = split ("https://user@example.com:8080/a/b?q=1#top");
+  EXPECT_EQ (fmt::format ("{}", p), "https://user@example.com:8080/a/b?q=1#top");
+  EXPECT_EQ (fmt::format ("{:o}", p), "https://example.com:8080");
+  EXPECT_EQ (fmt::format ("{:pq}", p), "/a/b?q=1");
+  EXPECT_EQ (fmt::format ("<{:s}|{:f}>", p, p), "<https:|#top>");
+}
+// NOLINTNEXTLINE
+TEST (FmtFormat, Authority) {
+  auto const p = split ("//user@example.com:8080");
+  ASSERT_TRUE (p.authority.has_value ());
+  EXPECT_EQ (fmt::format ("{}", *p.authority), "user@example.com:8080");
+  EXPECT_EQ (fmt::format ("{:h}", *p.authority), "example.com");
+}
+// NOLINTNEXTLINE
+TEST (FmtFormat, Path) {
+  auto const p = split ("/a/b/");
+  EXPECT_EQ (fmt::format ("{}", p.path), "/a/b/");
+}
+// NOLINTNEXTLINE
+TEST (FmtFormat, InvalidSpecification) {
+  auto const p = split ("/a");
+  std::string_view const spec = "{:x}";
+  EXPECT_THROW ((void)fmt::vformat (spec, fmt::make_format_args (p)), fmt::format_error);
+}
+#endif  // URI_HAVE_FMT
@@ -0,0 +1,240 @@
+//===- unittests/uri/test_grammar.cpp -------------------------------------===//
+//*  _            _                                                     *
+//* | |_ ___  ___| |_    __ _ _ __ __ _ _ __ ___  _ __ ___   __ _ _ __  *
+//* | __/ _ \/ __| __|  / _` | '__/ _` | '_ ` _ \| '_ ` _ \ / _` | '__| *
+//* | ||  __/\__ \ |_  | (_| | | | (_| | | | | | | | | | | | (_| | |    *
+//*  \__\___||___/\__|  \__, |_|  \__,_|_| |_| |_|_| |_| |_|\__,_|_|    *
+//*                     |___/                                           *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+#include "uri/grammar.hpp"
+
+using testing::ElementsAre;
+
+namespace {
+
+using namespace uri::grammar;
+
+using output = std::vector<std::string>;
+void remember (output& out, std::string_view const str) {
+  out.emplace_back (str);
+}
+void post (output& out, std::string_view const str) {
+  out.push_back ("post " + std::string{str});
+}
+
+using a = single_char<'a'>;
+using b = single_char<'b'>;
+using c = single_char<'c'>;
+
+// Grammars built from the templates can be evaluated at compile time.
+static_assert (matches<concat<a, b>> ("ab"));
+static_assert (matches<concat<a, b>> ("AB"));
+static_assert (!matches<concat<a, b>> ("abc"));
+static_assert (matches<star<hexdig, 1, 4>> ("F00d"));
+static_assert (!matches<star<hexdig, 1, 4>> ("12345"));
+static_assert (matches<char_range<'a', 'c'>> ("B"));
+static_assert (!matches<char_range<'a', 'c'>> ("d"));
+
+// Characters which star<> may consume in bulk. 'b' is excluded from the second
+// set because the earlier concat<b, c> must be given the chance to match it.
+static_assert (uri::grammar::details::run_set<alternative<a, c>>::value.test ('A'));
+static_assert (!uri::grammar::details::run_set<alternative<a, c>>::value.test ('b'));
+static_assert (uri::grammar::details::run_set<alternative<a, concat<b, c>, b>>::value.test ('a'));
+static_assert (!uri::grammar::details::run_set<alternative<a, concat<b, c>, b>>::value.test ('b'));
+static_assert (uri::grammar::details::run_set<alternative<alternative<a, concat<b, c>>, b>>::value.test ('a'));
+static_assert (!uri::grammar::details::run_set<alternative<alternative<a, concat<b, c>>, b>>::value.test ('b'));
+static_assert (uri::grammar::details::run_set<accept<a, &remember>>::value.empty ());
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (Grammar, Concat) {
+  output out;
+  EXPECT_TRUE ((parse<concat<accept<a, &remember>, accept<b, &remember>>> ("ab", out)));
+  EXPECT_THAT (out, ElementsAre ("a", "b"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, ConcatAcceptorOrder) {
+  output out;
+  EXPECT_TRUE ((parse<accept<concat<accept<a, &remember>, accept<b, &remember>>, &post>> ("ab", out)));
+  EXPECT_THAT (out, ElementsAre ("a", "b", "post ab"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, FirstAlternative) {
+  output out;
+  EXPECT_TRUE ((parse<concat<accept<a, &remember>, alternative<accept<b, &remember>, accept<c, &remember>>>> ("ab", out)));
+  EXPECT_THAT (out, ElementsAre ("a", "b"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, SecondAlternative) {
+  output out;
+  EXPECT_TRUE ((parse<concat<accept<a, &remember>, alternative<accept<b, &remember>, accept<c, &remember>>>> ("ac", out)));
+  EXPECT_THAT (out, ElementsAre ("a", "c"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, AlternativeRollsBackAcceptors) {
+  // The first alternative matches "a" and records an acceptor before failing
+  // on "b". That record must not survive.
+  output out;
+  EXPECT_TRUE ((parse<alternative<concat<accept<a, &remember>, b>, accept<concat<a, c>, &remember>>> ("ac", out)));
+  EXPECT_THAT (out, ElementsAre ("ac"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, AlternativeFail) {
+  output out;
+  EXPECT_FALSE ((parse<concat<accept<a, &remember>, alternative<accept<b, &remember>, accept<c, &remember>>>> ("ad", out)));
+  EXPECT_TRUE (out.empty ());
+}
+// NOLINTNEXTLINE
+TEST (Grammar, Star) {
+  output out;
+  EXPECT_TRUE ((parse<star<accept<a, &remember>>> ("aaa", out)));
+  EXPECT_THAT (out, ElementsAre ("a", "a", "a"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, StarMinMax) {
+  EXPECT_FALSE ((matches<star<a, 2, 3>> ("a")));
+  EXPECT_TRUE ((matches<star<a, 2, 3>> ("aa")));
+  EXPECT_TRUE ((matches<star<a, 2, 3>> ("aaa")));
+  EXPECT_FALSE ((matches<star<a, 2, 3>> ("aaaa")));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, StarConcat) {
+  output out;
+  EXPECT_TRUE ((parse<concat<star<accept<a, &remember>>, accept<b, &remember>>> ("aab", out)));
+  EXPECT_THAT (out, ElementsAre ("a", "a", "b"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, Optional) {
+  output out;
+  EXPECT_TRUE ((parse<concat<optional<accept<a, &remember>>, accept<b, &remember>>> ("b", out)));
+  EXPECT_THAT (out, ElementsAre ("b"));
+  out.clear ();
+  EXPECT_TRUE ((parse<concat<optional<accept<a, &remember>>, accept<b, &remember>>> ("ab", out)));
+  EXPECT_THAT (out, ElementsAre ("a", "b"));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, NotFollowedBy) {
+  EXPECT_TRUE ((matches<concat<a, not_followed_by<a>>> ("a")));
+  EXPECT_FALSE ((matches<concat<a, not_followed_by<a>, star<a>>> ("aa")));
+}
+// NOLINTNEXTLINE
+TEST (Grammar, IncompleteMatchDoesNotCallAcceptors) {
+  output out;
+  EXPECT_FALSE ((parse<accept<a, &remember>> ("ab", out)));
+  EXPECT_TRUE (out.empty ());
+}
+// NOLINTNEXTLINE
+TEST (Grammar, InlineCapacityDoesNotAllocate) {
+  // A match which records no more than inline_capacity acceptors must not
+  // touch the upstream memory resource.
+  std::string const input (context<output>::inline_capacity, 'a');
+  context<output> ctx{input, std::pmr::null_memory_resource ()};
+  EXPECT_TRUE ((star<accept<a, &remember>>::match (ctx)));
+  output out;
+  EXPECT_TRUE (ctx.done (out));
+  EXPECT_EQ (out.size (), context<output>::inline_capacity);
+}
+// NOLINTNEXTLINE
+TEST (Grammar, StarRunsMatchStepwise) {
+  // star<> over a rule with a non-empty run_set scans runs of characters in
+  // bulk. Wrapping the rule in accept<> disables the bulk scan, giving a
+  // reference result for comparison.
+  using rule = alternative<alternative<a, concat<b, c>>, b, concat<single_char<'%'>, hexdig>>;
+  using stepwise = accept<rule, &remember>;
+  std::string_view const alphabet = "abcC%1";
+  std::vector<std::string> inputs{std::string{}};
+  for (auto length = 0U; length < 5U; ++length) {
+    auto const prev = inputs.size ();
+    for (auto ctr = std::size_t{0}; ctr < prev; ++ctr) {
+      if (inputs[ctr].length () == length) {
+        for (auto const ch : alphabet) {
+          inputs.push_back (inputs[ctr] + ch);
+        }
+      }
+    }
+  }
+  for (auto const& input : inputs) {
+    EXPECT_EQ ((matches<star<rule>> (input)), (matches<star<stepwise>> (input))) << input;
+    EXPECT_EQ ((matches<star<rule, 2, 3>> (input)), (matches<star<stepwise, 2, 3>> (input))) << input;
+    EXPECT_EQ ((matches<concat<star<rule, 0, 2>, star<c>>> (input)),
+               (matches<concat<star<stepwise, 0, 2>, star<c>>> (input)))
+      << input;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST (Grammar, StarRunsTryRuleAtEnd) {
+  // Once the input is exhausted, star<> must still try the rule since it may
+  // match the empty string and record an acceptor. memo<> has an empty run_set
+  // and so gives a reference result for comparison.
+  using rule = alternative<a, accept<optional<b>, &post>>;
+  using stepwise = memo<rule>;
+  static_assert (!uri::grammar::details::run_set<rule>::value.empty ());
+  static_assert (uri::grammar::details::run_set<stepwise>::value.empty ());
+  for (std::string_view const input : {"", "a", "aa", "ab", "aab", "ba"}) {
+    output bulk;
+    output each;
+    EXPECT_EQ ((parse<star<rule, 1>> (input, bulk)), (parse<star<stepwise, 1>> (input, each))) << input;
+    EXPECT_EQ (bulk, each) << input;
+  }
+  output out;
+  EXPECT_TRUE ((parse<star<rule, 1>> ("aa", out)));
+  EXPECT_THAT (out, ElementsAre ("post "));
+}
+
+namespace {
+
+/// Matches \p Rule and counts the number of times that it is evaluated.
+template <typename Rule>
+struct counted {
+  static inline unsigned evaluations = 0;
+  template <typename Context>
+  static constexpr bool match (Context& ctx) {
+    ++evaluations;
+    return Rule::match (ctx);
+  }
+};
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (Grammar, MemoReplaysAcceptors) {
+  // Both alternatives begin with the same memoized production. The first
+  // alternative fails after the production has matched so, with memoization
+  // enabled, the second replays the earlier result (including its acceptors)
+  // rather than matching the input again.
+  using prefix = counted<star<accept<a, &remember>>>;
+  using rule = alternative<concat<memo<prefix>, b>, concat<memo<prefix>, accept<c, &remember>>>;
+
+  prefix::evaluations = 0;
+  output out;
+  EXPECT_TRUE ((parse<rule> ("aac", out, memoization::off)));
+  EXPECT_THAT (out, ElementsAre ("a", "a", "c"));
+  EXPECT_EQ (prefix::evaluations, 2U);
+
+  prefix::evaluations = 0;
+  out.clear ();
+  EXPECT_TRUE ((parse<rule> ("aac", out, memoization::on)));
+  EXPECT_THAT (out, ElementsAre ("a", "a", "c"));
+  EXPECT_EQ (prefix::evaluations, 1U);
+}
+// NOLINTNEXTLINE
+TEST (Grammar, MemoRecordsFailure) {
+  using word = counted<concat<a, b>>;
+  using rule = alternative<concat<memo<word>, c>, memo<word>, accept<a, &remember>>;
+  word::evaluations = 0;
+  output out;
+  EXPECT_TRUE ((parse<rule> ("a", out, memoization::on)));
+  EXPECT_THAT (out, ElementsAre ("a"));
+  EXPECT_EQ (word::evaluations, 1U);
+}
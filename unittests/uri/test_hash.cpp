@@ -0,0 +1,132 @@
+//===- unittests/uri/test_hash.cpp ----------------------------------------===//
+//*  _            _     _               _      *
+//* | |_ ___  ___| |_  | |__   __ _ ___| |__   *
+//* | __/ _ \/ __| __| | '_ \ / _` / __| '_ \  *
+//* | ||  __/\__ \ |_  | | | | (_| \__ \ | | | *
+//*  \__\___||___/\__| |_| |_|\__,_|___/_| |_| *
+//*                                            *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "uri/hash.hpp"
+#include "uri/parts.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+uri::parts split (std::string_view const s) {
+  auto p = uri::split_reference (s);
+  EXPECT_TRUE (p.has_value ()) << s;
+  return p.value_or (uri::parts{});
+}
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (Hash, EqualPartsHaveEqualHashes) {
+  std::string const a = "http://user@example.com:80/a/b?q#f";
+  std::string const b = a;  // A separate copy of the same text.
+  EXPECT_EQ (uri::hash (split (a)), uri::hash (split (b)));
+  EXPECT_EQ (std::hash<uri::parts>{}(split (a)), std::hash<uri::parts>{}(split (b)));
+  EXPECT_EQ (std::hash<struct uri::parts::path>{}(split (a).path), std::hash<struct uri::parts::path>{}(split (b).path));
+  EXPECT_EQ (std::hash<struct uri::parts::authority>{}(*split (a).authority),
+             std::hash<struct uri::parts::authority>{}(*split (b).authority));
+}
+// NOLINTNEXTLINE
+TEST (Hash, AbsoluteIgnoredWithAuthority) {
+  // operator== ignores the path's absolute flag when both have an authority.
+  auto x = split ("//host/a");
+  auto y = x;
+  y.path.absolute = !x.path.absolute;
+  ASSERT_EQ (x, y);
+  EXPECT_EQ (uri::hash (x), uri::hash (y));
+  // ... but not otherwise.
+  EXPECT_NE (uri::hash (split ("/a")), uri::hash (split ("a")));
+  EXPECT_NE (uri::hash (x.path), uri::hash (y.path));
+}
+// NOLINTNEXTLINE
+TEST (Hash, Boundaries) {
+  // Each pair differs only in where the component boundaries fall or whether
+  // an empty component is present.
+  for (auto const& [lhs, rhs] : {std::pair{"/ab"sv, "/a/b"sv}, std::pair{"/a"sv, "/a/"sv}, std::pair{"?"sv, ""sv},
+                                 std::pair{"#"sv, ""sv}, std::pair{"?#"sv, "#"sv}, std::pair{"?a"sv, "#a"sv},
+                                 std::pair{"//@h"sv, "//h"sv}, std::pair{"//h:"sv, "//h"sv},
+                                 std::pair{"//a@b"sv, "//ab"sv}, std::pair{"//"sv, ""sv}, std::pair{"a:"sv, ""sv},
+                                 std::pair{"//a/b"sv, "/a/b"sv}}) {
+    auto const l = split (lhs);
+    auto const r = split (rhs);
+    ASSERT_NE (l, r) << lhs << " " << rhs;
+    EXPECT_NE (uri::hash (l), uri::hash (r)) << lhs << " " << rhs;
+  }
+}
+// NOLINTNEXTLINE
+TEST (Hash, NoCollisions) {
+  std::vector<std::string> inputs;
+  for (auto ctr = 0; ctr < 10000; ++ctr) {
+    inputs.push_back ("http://host" + std::to_string (ctr % 100) + "/p/" + std::to_string (ctr) + "?q");
+  }
+  std::unordered_set<std::uint64_t> hashes;
+  for (auto const& input : inputs) {
+    hashes.insert (uri::hash (split (input)));
+  }
+  EXPECT_EQ (hashes.size (), inputs.size ());
+}
+// NOLINTNEXTLINE
+TEST (Hash, UnorderedSet) {
+  std::string const text = "http://example.com/a";
+  std::unordered_set<uri::parts> s;
+  s.insert (split (text));
+  s.insert (split ("http://example.com/b"));
+  EXPECT_EQ (s.size (), 2U);
+  EXPECT_TRUE (s.contains (split (std::string{text})));
+  EXPECT_FALSE (s.contains (split ("http://example.com/c")));
+}
+// NOLINTNEXTLINE
+TEST (Hash, Normalize) {
+  std::vector<char> store;
+  auto const n = uri::normalize (store, split ("HTTP://User@Ex%41mple.COM:/a/./b/../c/%7euser%2f?%61%3d#%7E%2b"));
+  EXPECT_EQ (n.scheme, "http");
+  ASSERT_TRUE (n.authority.has_value ());
+  EXPECT_EQ (n.authority->userinfo, "User");
+  EXPECT_EQ (n.authority->host, "example.com");
+  EXPECT_EQ (n.authority->port, std::nullopt);
+  EXPECT_THAT (n.path.segments, testing::ElementsAre ("a", "c", "~user%2F"));
+  EXPECT_EQ (n.query, "a%3D");
+  EXPECT_EQ (n.fragment, "~%2B");
+
+  // Dot-segments are meaningful in a relative path.
+  EXPECT_THAT (uri::normalize (store, split ("../a/./b")).path.segments, testing::ElementsAre ("..", "a", ".", "b"));
+}
+// NOLINTNEXTLINE
+TEST (Hash, NormalizedEquivalence) {
+  uri::normalized_hash const h;
+  uri::normalized_equal const eq;
+  for (auto const& [lhs, rhs] :
+       {std::pair{"http://example.com/a"sv, "HTTP://EXAMPLE.com/a"sv}, std::pair{"a:/%7e"sv, "a:/~"sv},
+        std::pair{"a:/%2f"sv, "a:/%2F"sv}, std::pair{"http://h:/"sv, "http://h/"sv},
+        std::pair{"http://h/a/../b/./c"sv, "http://h/b/c"sv}, std::pair{"http://h/%2E%2E/a"sv, "http://h/a"sv}}) {
+    auto const l = split (lhs);
+    auto const r = split (rhs);
+    EXPECT_TRUE (eq (l, r)) << lhs << " " << rhs;
+    EXPECT_EQ (h (l), h (r)) << lhs << " " << rhs;
+  }
+  for (auto const& [lhs, rhs] : {std::pair{"http://h/A"sv, "http://h/a"sv}, std::pair{"a:/%2f"sv, "a:/"sv},
+                                 std::pair{"http://u@h/"sv, "http://U@h/"sv}, std::pair{"../a"sv, "a"sv}}) {
+    auto const l = split (lhs);
+    auto const r = split (rhs);
+    EXPECT_FALSE (eq (l, r)) << lhs << " " << rhs;
+    EXPECT_NE (h (l), h (r)) << lhs << " " << rhs;
+  }
+  std::unordered_set<uri::parts, uri::normalized_hash, uri::normalized_equal> s;
+  s.insert (split ("HTTP://Example.COM/a/./b"));
+  EXPECT_TRUE (s.contains (split ("http://example.com/a/b")));
+}
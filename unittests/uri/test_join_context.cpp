@@ -0,0 +1,103 @@
+//===- unittests/uri/test_join_context.cpp --------------------------------===//
+//*  _            _       _       _                         _            _    *
+//* | |_ ___  ___| |_    (_) ___ (_)_ __     ___ ___  _ __ | |_ _____  _| |_  *
+//* | __/ _ \/ __| __|   | |/ _ \| | '_ \   / __/ _ \| '_ \| __/ _ \ \/ / __| *
+//* | ||  __/\__ \ |_    | | (_) | | | | | | (_| (_) | | | | ||  __/>  <| |_  *
+//*  \__\___||___/\__|  _/ |\___/|_|_| |_|  \___\___/|_| |_|\__\___/_/\_\\__| *
+//*                    |__/                                                   *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <array>
+#include <memory_resource>
+#include <string_view>
+
+#include "uri/join_context.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+// The references from RFC 3986 section 5.4 together with some which exercise
+// IP-literals and bases with short paths.
+constexpr std::array references{
+  "g:h"sv,     "g"sv,         "./g"sv,      "g/"sv,       "/g"sv,       "//g"sv,       "?y"sv,         "g?y"sv,
+  "#s"sv,      "g#s"sv,       "g?y#s"sv,    ";x"sv,       "g;x"sv,      "g;x?y#s"sv,   ""sv,           "."sv,
+  "./"sv,      ".."sv,        "../"sv,      "../g"sv,     "../.."sv,    "../../"sv,    "../../g"sv,    "../../../g"sv,
+  "/./g"sv,    "/../g"sv,     "g."sv,       ".g"sv,       "g.."sv,      "..g"sv,       "./../g"sv,     "./g/."sv,
+  "g/./h"sv,   "g/../h"sv,    "g;x=1/./y"sv, "g;x=1/../y"sv, "g?y/./x"sv, "g#s/../x"sv, "http:g"sv,    "http:/g/../h"sv,
+  "//[::1]/a"sv, "//[::1]:80/./b"sv, "http://[v7.x]/c/.."sv,
+};
+
+constexpr std::array bases{
+  "http://a/b/c/d;p?q"sv, "http://a"sv, "http://a/"sv, "http://a/b"sv, "file:///x/y/"sv, "mailto:x@y.z"sv,
+  "a:b"sv,                "a:"sv,       "http://[::1]/a/b?q"sv,
+};
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (JoinContext, MatchesJoin) {
+  for (auto const strict : {true, false}) {
+    for (auto const base : bases) {
+      auto const ctx = uri::join_context::make (base, strict);
+      ASSERT_TRUE (ctx.has_value ()) << base;
+      for (auto const reference : references) {
+        EXPECT_EQ (ctx->join (reference), uri::join (base, reference, strict))
+          << "base=" << base << " reference=" << reference << " strict=" << strict;
+      }
+    }
+  }
+}
+// NOLINTNEXTLINE
+TEST (JoinContext, ReusesTarget) {
+  auto const ctx = uri::join_context::make ("http://a/b/c/d;p?q");
+  ASSERT_TRUE (ctx.has_value ());
+  uri::parts target;
+  // Each result must be independent of whatever the target held before.
+  for (auto const reference : references) {
+    ASSERT_TRUE (ctx->join (reference, target)) << reference;
+    EXPECT_EQ (target, uri::join ("http://a/b/c/d;p?q", reference)) << reference;
+  }
+}
+// NOLINTNEXTLINE
+TEST (JoinContext, Parts) {
+  auto const base = uri::split ("http://a/b/c/d;p?q");
+  ASSERT_TRUE (base.has_value ());
+  uri::join_context const ctx{*base};
+  EXPECT_EQ (ctx.base (), *base);
+  EXPECT_TRUE (ctx.strict ());
+
+  auto reference = uri::split_reference ("../g?y#s");
+  ASSERT_TRUE (reference.has_value ());
+  auto const expected = uri::join (*base, *reference);
+  EXPECT_EQ (ctx.join (*reference), expected);
+  // The reference may also be the target.
+  ctx.join (*reference, *reference);
+  EXPECT_EQ (*reference, expected);
+}
+// NOLINTNEXTLINE
+TEST (JoinContext, Invalid) {
+  EXPECT_FALSE (uri::join_context::make ("not a uri").has_value ());
+  EXPECT_FALSE (uri::join_context::make ("relative/path").has_value ());
+  auto const ctx = uri::join_context::make ("http://a/b");
+  ASSERT_TRUE (ctx.has_value ());
+  uri::parts target;
+  EXPECT_FALSE (ctx->join ("a b"sv, target));
+  EXPECT_FALSE (ctx->join ("http://[::1"sv).has_value ());
+}
+// NOLINTNEXTLINE
+TEST (JoinContext, MemoryResource) {
+  std::array<std::byte, 1024> buffer{};
+  std::pmr::monotonic_buffer_resource arena{buffer.data (), buffer.size (), std::pmr::null_memory_resource ()};
+  auto const ctx = uri::join_context::make ("http://a/b/c/d/e/f/g/h", true, &arena);
+  ASSERT_TRUE (ctx.has_value ());
+  auto const target = ctx->join ("i/j/k"sv, &arena);
+  ASSERT_TRUE (target);
+  EXPECT_EQ (target, uri::split ("http://a/b/c/d/e/f/g/i/j/k"));
+  EXPECT_EQ (target->path.segments.get_allocator ().resource (), &arena);
+}
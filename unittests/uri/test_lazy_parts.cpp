@@ -0,0 +1,163 @@
+//===- unittests/uri/test_lazy_parts.cpp ----------------------------------===//
+//*  _            _     _                                    _        *
+//* | |_ ___  ___| |_  | | __ _ _____   _   _ __   __ _ _ __| |_ ___  *
+//* | __/ _ \/ __| __| | |/ _` |_  / | | | | '_ \ / _` | '__| __/ __| *
+//* | ||  __/\__ \ |_  | | (_| |/ /| |_| | | |_) | (_| | |  | |_\__ \ *
+//*  \__\___||___/\__| |_|\__,_/___|\__, | | .__/ \__,_|_|   \__|___/ *
+//*                                 |___/  |_|                        *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <array>
+#include <string_view>
+
+#include "uri/lazy_parts.hpp"
+
+using namespace std::string_view_literals;
+using testing::ElementsAre;
+
+namespace {
+
+constexpr std::array inputs{
+    ""sv,
+    "/"sv,
+    "a"sv,
+    "a/"sv,
+    "//"sv,
+    "///"sv,
+    "?"sv,
+    "#"sv,
+    ":"sv,
+    ":a"sv,
+    "a:"sv,
+    "a:b:c"sv,
+    "1a:b"sv,
+    "a b:c"sv,
+    "./this:that"sv,
+    "this:that"sv,
+    "a/b:c"sv,
+    "http://user@example.com:8080/a/b/c?q=1#frag"sv,
+    "http://example.com"sv,
+    "http://example.com/"sv,
+    "http://@example.com:"sv,
+    "http://a@b@c/"sv,
+    "http://host:port/"sv,
+    "http://1.2.3.4/"sv,
+    "http://1.2.3.4x/"sv,
+    "http://[::1]/"sv,
+    "http://[::1]:80/a"sv,
+    "http://[v7.fe]/"sv,
+    "http://[::1/"sv,
+    "http://[::1]x/"sv,
+    "http://[::1]:8x/"sv,
+    "ftp://ftp.is.co.za/rfc/rfc1808.txt"sv,
+    "mailto:John.Doe@example.com"sv,
+    "news:comp.infosystems.www.servers.unix"sv,
+    "tel:+1-816-555-1212"sv,
+    "urn:oasis:names:specification:docbook:dtd:xml:4.1.2"sv,
+    "foo://info.example.com?fred"sv,
+    "a:/b//c/d/e/f/g/h/i/j/k/l"sv,
+    "//example.com/a%20b?c%2fd#e%3F"sv,
+    "/a%2"sv,
+    "/a%zz"sv,
+    "/a b"sv,
+    "?a b"sv,
+    "#a#b"sv,
+    "#a?b/c"sv,
+    "g;x?y#s"sv,
+    "../g"sv,
+    "/a:b"sv,
+    "/x/y:z"sv,
+    "/_::"sv,
+    "a:b/c"sv,
+    "./a:b"sv,
+};
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (LazyParts, MatchesSplit) {
+  for (auto const in : inputs) {
+    auto const expected = uri::split (in);
+    auto const lazy = uri::split_lazy (in);
+    if (!lazy) {
+      EXPECT_FALSE (expected.has_value ()) << "input: " << in;
+      continue;
+    }
+    EXPECT_EQ (lazy->valid (), expected.has_value ()) << "input: " << in;
+    EXPECT_EQ (lazy->to_parts (), expected) << "input: " << in;
+  }
+}
+// NOLINTNEXTLINE
+TEST (LazyParts, MatchesSplitReference) {
+  for (auto const in : inputs) {
+    auto const expected = uri::split_reference (in);
+    auto const lazy = uri::split_reference_lazy (in);
+    ASSERT_TRUE (lazy.has_value ()) << "input: " << in;
+    EXPECT_EQ (lazy->valid (), expected.has_value ()) << "input: " << in;
+    EXPECT_EQ (lazy->to_parts (), expected) << "input: " << in;
+  }
+}
+// NOLINTNEXTLINE
+TEST (LazyParts, NoScheme) {
+  EXPECT_FALSE (uri::split_lazy ("/a/b").has_value ());
+  EXPECT_FALSE (uri::split_lazy ("//host").has_value ());
+  EXPECT_FALSE (uri::split_lazy (":a").has_value ());
+}
+// NOLINTNEXTLINE
+TEST (LazyParts, Accessors) {
+  auto const p = uri::split_lazy ("http://user@[::1]:8080/a/b/c?q=1#frag");
+  ASSERT_TRUE (p.has_value ());
+  EXPECT_EQ (p->scheme (), "http");
+  EXPECT_TRUE (p->has_authority ());
+  EXPECT_EQ (p->userinfo (), "user");
+  EXPECT_EQ (p->host (), "[::1]");
+  EXPECT_EQ (p->port (), "8080");
+  EXPECT_EQ (p->query (), "q=1");
+  EXPECT_EQ (p->fragment (), "frag");
+  EXPECT_TRUE (p->path ().absolute);
+  EXPECT_THAT (p->path ().segments, ElementsAre ("a", "b", "c"));
+  // A second call returns the same materialized path.
+  EXPECT_EQ (&p->path (), &p->path ());
+}
+// NOLINTNEXTLINE
+TEST (LazyParts, FieldValidity) {
+  // The host is valid even though the path and query are not.
+  auto const p = uri::split_lazy ("http://example.com/a b?c d");
+  ASSERT_TRUE (p.has_value ());
+  EXPECT_TRUE (p->valid (uri::parts_field::scheme));
+  EXPECT_TRUE (p->valid (uri::parts_field::host));
+  EXPECT_TRUE (p->valid (uri::parts_field::userinfo));
+  EXPECT_TRUE (p->valid (uri::parts_field::port));
+  EXPECT_FALSE (p->valid (uri::parts_field::path));
+  EXPECT_FALSE (p->valid (uri::parts_field::query));
+  EXPECT_TRUE (p->valid (uri::parts_field::fragment));
+  EXPECT_FALSE (p->valid ());
+  EXPECT_FALSE (p->to_parts ().has_value ());
+
+  auto const q = uri::split_lazy ("http://exa mple.com:80/a");
+  ASSERT_TRUE (q.has_value ());
+  EXPECT_EQ (q->host (), "exa mple.com");
+  EXPECT_FALSE (q->valid (uri::parts_field::host));
+  EXPECT_FALSE (q->valid (uri::parts_field::port));
+  EXPECT_TRUE (q->valid (uri::parts_field::path));
+}
+// NOLINTNEXTLINE
+TEST (LazyParts, MemoryResource) {
+  // More segments than fit inline so that materializing the path must
+  // allocate.
+  auto const in = "a:/1/2/3/4/5/6/7/8/9/10"sv;
+  std::array<std::byte, 1024> buffer{};
+  std::pmr::monotonic_buffer_resource resource{buffer.data (), buffer.size (), std::pmr::null_memory_resource ()};
+  auto const p = uri::split_lazy (in, &resource);
+  ASSERT_TRUE (p.has_value ());
+  EXPECT_EQ (p->path ().segments.get_allocator ().resource (), &resource);
+  auto const q = p->to_parts ();
+  ASSERT_TRUE (q.has_value ());
+  EXPECT_EQ (q->path.segments.get_allocator ().resource (), &resource);
+  EXPECT_EQ (q, uri::split (in));
+}
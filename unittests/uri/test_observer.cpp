@@ -0,0 +1,117 @@
+//===- unittests/uri/test_observer.cpp ------------------------------------===//
+//*  _            _           _                                   *
+//* | |_ ___  ___| |_    ___ | |__  ___  ___ _ ____   _____ _ __  *
+//* | __/ _ \/ __| __|  / _ \| '_ \/ __|/ _ \ '__\ \ / / _ \ '__| *
+//* | ||  __/\__ \ |_  | (_) | |_) \__ \  __/ |   \ V /  __/ |    *
+//*  \__\___||___/\__|  \___/|_.__/|___/\___|_|    \_/ \___|_|    *
+//*                                                               *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <sstream>
+
+#include "uri/observer.hpp"
+#include "uri/rule.hpp"
+#include "uri/uri.hpp"
+
+using testing::Contains;
+using testing::Key;
+using testing::Not;
+
+namespace {
+
+/// Installs an observer for the lifetime of the object.
+class scoped_observer {
+public:
+  explicit scoped_observer (uri::production_observer* const observer)
+      : prev_{uri::set_production_observer (observer)} {}
+  scoped_observer (scoped_observer const&) = delete;
+  scoped_observer (scoped_observer&&) noexcept = delete;
+  ~scoped_observer () noexcept { uri::set_production_observer (prev_); }
+
+  scoped_observer& operator= (scoped_observer const&) = delete;
+  scoped_observer& operator= (scoped_observer&&) noexcept = delete;
+
+private:
+  uri::production_observer* prev_;
+};
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (ProductionCounters, Evaluated) {
+  uri::production_counters counters;
+  counters.evaluated ("a", true, 3);
+  counters.evaluated ("a", false, 0);
+  counters.evaluated ("b", true, 1);
+  auto const& stats = counters.stats ();
+  ASSERT_EQ (stats.size (), 2U);
+  auto const& a = stats.at ("a");
+  EXPECT_EQ (a.invocations, 2U);
+  EXPECT_EQ (a.successes, 1U);
+  EXPECT_EQ (a.backtracks, 1U);
+  EXPECT_EQ (a.bytes, 3U);
+  auto const& b = stats.at ("b");
+  EXPECT_EQ (b.invocations, 1U);
+  EXPECT_EQ (b.successes, 1U);
+  EXPECT_EQ (b.backtracks, 0U);
+  EXPECT_EQ (b.bytes, 1U);
+
+  counters.clear ();
+  EXPECT_TRUE (counters.stats ().empty ());
+}
+// NOLINTNEXTLINE
+TEST (ProductionCounters, Write) {
+  uri::production_counters counters;
+  counters.evaluated ("pchar", true, 1);
+  std::ostringstream os;
+  os << counters;
+  EXPECT_THAT (os.str (), testing::HasSubstr ("pchar"));
+}
+// NOLINTNEXTLINE
+TEST (ProductionObserver, Rule) {
+  uri::production_counters counters;
+  {
+    scoped_observer const observer{&counters};
+    uri::acceptor_log log;
+    auto const ab = [] (uri::rule const& r) {
+      return r.concat (uri::single_char ('a')).concat (uri::single_char ('b')).matched ("ab", r);
+    };
+    EXPECT_TRUE (uri::rule ("ab", log).concat (ab).done ());
+    EXPECT_FALSE (uri::rule ("ac", log).concat (ab).done ());
+  }
+  if constexpr (uri::observe_productions) {
+    auto const& ab = counters.stats ().at ("ab");
+    EXPECT_EQ (ab.invocations, 2U);
+    EXPECT_EQ (ab.successes, 1U);
+    EXPECT_EQ (ab.backtracks, 1U);
+    EXPECT_EQ (ab.bytes, 2U);
+  } else {
+    EXPECT_TRUE (counters.stats ().empty ());
+  }
+}
+// NOLINTNEXTLINE
+TEST (ProductionObserver, Split) {
+  uri::production_counters counters;
+  {
+    scoped_observer const observer{&counters};
+    EXPECT_TRUE (uri::details::split_reference_rules ("//[::1]/a").has_value ());
+  }
+  if constexpr (uri::observe_productions) {
+    auto const& stats = counters.stats ();
+    // URI is tried first and fails. The input is then matched as a relative
+    // reference.
+    EXPECT_EQ (stats.at ("URI").backtracks, 1U);
+    EXPECT_EQ (stats.at ("relative-ref").successes, 1U);
+    EXPECT_EQ (stats.at ("relative-ref").bytes, 9U);
+    EXPECT_EQ (stats.at ("IPv6address").successes, 1U);
+    EXPECT_EQ (stats.at ("IPv6address").bytes, 3U);
+    EXPECT_THAT (stats, Not (Contains (Key ("IPvFuture"))));
+  } else {
+    EXPECT_TRUE (counters.stats ().empty ());
+  }
+}
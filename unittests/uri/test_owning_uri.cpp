@@ -0,0 +1,183 @@
+//===- unittests/uri/test_owning_uri.cpp ----------------------------------===//
+//*  _            _                         _                          _  *
+//* | |_ ___  ___| |_    _____      ___ __ (_)_ __   __ _   _   _ _ __(_) *
+//* | __/ _ \/ __| __|  / _ \ \ /\ / / '_ \| | '_ \ / _` | | | | | '__| | *
+//* | ||  __/\__ \ |_  | (_) \ V  V /| | | | | | | | (_| | | |_| | |  | | *
+//*  \__\___||___/\__|  \___/ \_/\_/ |_| |_|_|_| |_|\__, |  \__,_|_|  |_| *
+//*                                                 |___/                 *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "uri/owning_uri.hpp"
+
+using namespace std::string_view_literals;
+using testing::ElementsAre;
+
+namespace {
+
+// Checks that the boundaries recorded by \p u are those that would be found by
+// parsing its text afresh.
+::testing::AssertionResult consistent (uri::owning_uri const& u) {
+  auto const fresh = uri::owning_uri::parse_reference (u.str ());
+  if (!fresh) {
+    return ::testing::AssertionFailure () << std::quoted (u.str ()) << " is not a valid URI-reference";
+  }
+  if (fresh->bounds () != u.bounds ()) {
+    return ::testing::AssertionFailure () << "the boundaries of " << std::quoted (u.str ()) << " are incorrect";
+  }
+  return ::testing::AssertionSuccess ();
+}
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (OwningUri, Empty) {
+  uri::owning_uri const u;
+  EXPECT_EQ (u.str (), "");
+  EXPECT_EQ (u.scheme (), std::nullopt);
+  EXPECT_FALSE (u.has_authority ());
+  EXPECT_EQ (u.path (), "");
+  EXPECT_EQ (u.to_parts (), uri::split_reference (""));
+  static_assert (sizeof (uri::owning_uri) == sizeof (void*));
+}
+// NOLINTNEXTLINE
+TEST (OwningUri, Parse) {
+  std::string source = "http://user@example.com:8080/a/b?q=1#frag";
+  auto const u = uri::owning_uri::parse (source);
+  ASSERT_TRUE (u.has_value ());
+  EXPECT_EQ (u->to_parts (), uri::split (source));
+  // The owning_uri owns a copy of its text.
+  source.assign (source.length (), 'x');
+  EXPECT_EQ (u->str (), "http://user@example.com:8080/a/b?q=1#frag");
+  EXPECT_EQ (u->scheme (), "http");
+  EXPECT_EQ (u->userinfo (), "user");
+  EXPECT_EQ (u->host (), "example.com");
+  EXPECT_EQ (u->port (), "8080");
+  EXPECT_EQ (u->path (), "/a/b");
+  EXPECT_EQ (u->query (), "q=1");
+  EXPECT_EQ (u->fragment (), "frag");
+  EXPECT_THAT (u->to_parts ().path.segments, ElementsAre ("a", "b"));
+
+  EXPECT_FALSE (uri::owning_uri::parse ("/a/b").has_value ());
+  EXPECT_FALSE (uri::owning_uri::parse ("http://a b/").has_value ());
+  EXPECT_TRUE (uri::owning_uri::parse_reference ("/a/b").has_value ());
+  EXPECT_EQ (uri::owning_uri::parse_reference ("a:b/c")->path (), "b/c");
+}
+// NOLINTNEXTLINE
+TEST (OwningUri, ParseReferenceMatchesSplitReference) {
+  for (auto const in : {""sv, "/a:b"sv, "/x/y:z"sv, "/_::"sv, "/2.x:#http://"sv, "a:b"sv, "a:b/c"sv, ":a"sv,
+                        "./a:b"sv, "../g"sv, "g;x?y#s"sv, "//h/a:b"sv, "?a:b"sv, "#a:b"sv, "/a b"sv, "/a%2"sv,
+                        "http://[::1]:80/a"sv, "http://[::1/"sv}) {
+    auto const expected = uri::split_reference (in);
+    auto const u = uri::owning_uri::parse_reference (in);
+    EXPECT_EQ (u.has_value (), expected.has_value ()) << "input: " << std::quoted (in);
+    if (u && expected) {
+      EXPECT_EQ (u->to_parts (), *expected) << "input: " << std::quoted (in);
+    }
+  }
+}
+// NOLINTNEXTLINE
+TEST (OwningUri, CopyShares) {
+  auto u = uri::owning_uri::parse ("http://example.com/");
+  ASSERT_TRUE (u.has_value ());
+  uri::owning_uri const copy = *u;
+  EXPECT_EQ (copy.str ().data (), u->str ().data ());
+  EXPECT_EQ (copy, *u);
+
+  uri::owning_uri moved = std::move (*u);
+  EXPECT_EQ (moved.str ().data (), copy.str ().data ());
+
+  // Modifying one instance does not affect those with which it shared text.
+  EXPECT_TRUE (moved.set_host ("example.org"));
+  EXPECT_EQ (moved.str (), "http://example.org/");
+  EXPECT_EQ (copy.str (), "http://example.com/");
+
+  uri::owning_uri assigned;
+  assigned = copy;
+  EXPECT_EQ (assigned, copy);
+  assigned = std::move (moved);
+  EXPECT_EQ (assigned.str (), "http://example.org/");
+}
+// NOLINTNEXTLINE
+TEST (OwningUri, SetHost) {
+  auto u = uri::owning_uri::parse ("http://user@example.com:80/a?q#f");
+  ASSERT_TRUE (u.has_value ());
+  EXPECT_TRUE (u->set_host ("[::1]"));
+  EXPECT_EQ (u->str (), "http://user@[::1]:80/a?q#f");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_TRUE (u->set_host (""));
+  EXPECT_EQ (u->str (), "http://user@:80/a?q#f");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_TRUE (u->set_host ("h"));
+  EXPECT_EQ (u->str (), "http://user@h:80/a?q#f");
+  EXPECT_TRUE (consistent (*u));
+
+  // Invalid hosts and those that would change the structure of the authority
+  // are rejected.
+  for (auto const host : {"a b"sv, "a:1"sv, "a@b"sv, "a/b"sv, "[::1"sv, "1.2.3.4x"sv}) {
+    EXPECT_FALSE (u->set_host (host)) << host;
+    EXPECT_EQ (u->str (), "http://user@h:80/a?q#f");
+  }
+}
+// NOLINTNEXTLINE
+TEST (OwningUri, AddHost) {
+  for (auto const& [before, after] : {std::pair{""sv, "//h"sv}, std::pair{"a:"sv, "a://h"sv},
+                                      std::pair{"a:/"sv, "a://h/"sv}, std::pair{"a:/b?q#f"sv, "a://h/b?q#f"sv},
+                                      std::pair{"?q"sv, "//h?q"sv}, std::pair{"#f"sv, "//h#f"sv}}) {
+    auto u = uri::owning_uri::parse_reference (before);
+    ASSERT_TRUE (u.has_value ()) << before;
+    EXPECT_TRUE (u->set_host ("h")) << before;
+    EXPECT_EQ (u->str (), after);
+    EXPECT_TRUE (consistent (*u));
+  }
+  // A rootless path cannot follow an authority.
+  auto u = uri::owning_uri::parse ("mailto:a@b.c");
+  ASSERT_TRUE (u.has_value ());
+  EXPECT_FALSE (u->set_host ("h"));
+  EXPECT_EQ (u->str (), "mailto:a@b.c");
+}
+// NOLINTNEXTLINE
+TEST (OwningUri, SetQuery) {
+  auto u = uri::owning_uri::parse ("http://h/#f");
+  ASSERT_TRUE (u.has_value ());
+  EXPECT_TRUE (u->set_query ("a=1"));
+  EXPECT_EQ (u->str (), "http://h/?a=1#f");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_TRUE (u->set_query ("a=22&b=3"));
+  EXPECT_EQ (u->str (), "http://h/?a=22&b=3#f");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_TRUE (u->set_query (""));
+  EXPECT_EQ (u->str (), "http://h/?#f");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_FALSE (u->set_query ("a b"));
+  EXPECT_FALSE (u->set_query ("a#b"));
+  EXPECT_EQ (u->str (), "http://h/?#f");
+  EXPECT_TRUE (u->set_query (std::nullopt));
+  EXPECT_EQ (u->str (), "http://h/#f");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_TRUE (u->set_query (std::nullopt));
+  EXPECT_EQ (u->str (), "http://h/#f");
+}
+// NOLINTNEXTLINE
+TEST (OwningUri, SetFragment) {
+  auto u = uri::owning_uri::parse ("a:/?");
+  ASSERT_TRUE (u.has_value ());
+  EXPECT_TRUE (u->set_fragment ("x/y?z"));
+  EXPECT_EQ (u->str (), "a:/?#x/y?z");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_EQ (u->query (), "");
+  EXPECT_EQ (u->path (), "/");
+  EXPECT_TRUE (u->set_fragment (std::nullopt));
+  EXPECT_EQ (u->str (), "a:/?");
+  EXPECT_TRUE (consistent (*u));
+  EXPECT_FALSE (u->set_fragment ("#"));
+}
@@ -148,7 +148,7 @@ TEST (Parts, AllSetButNothingToEncode) {
   input.scheme = "https"sv;
   input.authority = auth{"user"sv, "host"sv, "1234"sv};
   input.path.absolute = true;
-  input.path.segments = std::vector<std::string_view>{"a"sv, "b"sv};
+  input.path.segments = {"a"sv, "b"sv};
   input.query = "query"sv;
   input.fragment = "fragment"sv;
   ASSERT_TRUE (input.valid ());
@@ -180,7 +180,7 @@ TEST (Parts, EncodeDecode) {
   original.scheme = "https"sv;
   original.authority = auth{"user"sv, "M\xC3\xBCnchen.de"sv, "1234"sv};
   original.path.absolute = true;
-  original.path.segments = std::vector<std::string_view>{"~\xC2\xA1"sv};
+  original.path.segments = {"~\xC2\xA1"sv};
   original.query = "a%b"sv;
   original.fragment = "c%d"sv;
 
@@ -344,6 +344,83 @@ TEST (Parts, EncodeDecodeRoundTripManyPathElements) {
       "el12", "el%13", "el14", "el%15", "el16", "el%17", "el18", "el%19", "el20", "el%21", "el22", "el%23",
       "el24", "el%25", "el26", "el%27", "el28", "el%29", "el30", "el%31", "el32", "el%33", "el34", "el%35",
       "el36", "el%37", "el38", "el%39", "el40", "el%41", "el42", "el%43", "el44", "el%45", "el46", "el%47"};
-  EncodeDecodeRoundTrip ({std::nullopt, {true, std::move (elements)}, std::nullopt, std::nullopt},
+  EncodeDecodeRoundTrip ({std::nullopt, {true, {elements.begin (), elements.end ()}}, std::nullopt, std::nullopt},
                          auth{std::nullopt, "host", std::nullopt});
 }
+// NOLINTNEXTLINE
+TEST (Parts, EncodeDecodeMemoryResource) {
+  std::pmr::monotonic_buffer_resource arena;
+  std::pmr::vector<char> store{&arena};
+  uri::parts input;
+  input.path.segments = {"a b"sv, "c"sv, "d"sv, "e"sv, "f"sv, "g"sv, "h"sv, "i"sv, "j"sv};
+  uri::parts const encoded = uri::encode (store, input, &arena);
+  EXPECT_EQ (encoded.path.segments.get_allocator ().resource (), &arena);
+  EXPECT_EQ (encoded.path.segments.front (), "a%20b");
+
+  std::pmr::vector<char> decode_store{&arena};
+  auto const decoded = uri::decode (decode_store, encoded, &arena);
+  ASSERT_TRUE (std::holds_alternative<uri::parts> (decoded));
+  auto const& d = std::get<uri::parts> (decoded);
+  EXPECT_EQ (d.path.segments.get_allocator ().resource (), &arena);
+  EXPECT_EQ (d.path, input.path);
+}
+// NOLINTNEXTLINE
+TEST (Parts, RelocateCopiedSource) {
+  std::string const source = "http://user@example.com:80/a/b?q#f";
+  auto p = uri::split (source);
+  ASSERT_TRUE (p.has_value ());
+  std::string const copy = source;
+  uri::relocate (*p, source, copy);
+  EXPECT_EQ (p->scheme->data (), copy.data ());
+  EXPECT_EQ (p->fragment->data (), copy.data () + copy.length () - 1);
+  EXPECT_EQ (p->path.segments.front ().data (), copy.data () + copy.find ("/a") + 1);
+  EXPECT_EQ (uri::compose (*p), source);
+}
+// NOLINTNEXTLINE
+TEST (Parts, RelocateOnlyStringsInBuffer) {
+  // The scheme lies outside the buffer being relocated and is left alone.
+  auto const scheme = "http"sv;
+  auto const from = "host"sv;
+  auto const to = std::string{"host"};
+  uri::parts p;
+  p.scheme = scheme;
+  p.ensure_authority ().host = from;
+  uri::relocate (p, from, to);
+  EXPECT_EQ (p.scheme->data (), scheme.data ());
+  EXPECT_EQ (p.authority->host.data (), to.data ());
+}
+// NOLINTNEXTLINE
+TEST (Parts, RelocateAfterStoreReallocates) {
+  std::vector<char> store;
+  uri::parts input;
+  input.path.segments = {"a b"sv, "c d"sv};
+  auto encoded = uri::encode (store, input);
+  // Record the old buffer and force the store to move.
+  auto const old = std::string_view{store.data (), store.size ()};
+  std::vector<char> moved;
+  moved.reserve (store.size () + 1);
+  moved.assign (store.begin (), store.end ());
+  store = std::vector<char>{};
+  uri::relocate (encoded, old, std::string_view{moved.data (), moved.size ()});
+  EXPECT_THAT (encoded.path.segments, testing::ElementsAre ("a%20b", "c%20d"));
+}
+// NOLINTNEXTLINE
+TEST (Parts, Pack) {
+  std::vector<char> store;
+  uri::parts packed;
+  {
+    // A large buffer of which only a few bytes are referenced.
+    std::string const buffer = "http://example.com/a/b?q=1#f" + std::string (4096, ' ');
+    auto const p = uri::split (std::string_view{buffer}.substr (0, 28));
+    ASSERT_TRUE (p.has_value ());
+    packed = uri::pack (store, *p);
+    EXPECT_EQ (packed, *p);
+  }
+  EXPECT_EQ (store.size (), std::string_view{"httpexample.comabq=1f"}.length ());
+  EXPECT_EQ (packed.scheme, "http");
+  EXPECT_EQ (packed.authority->host, "example.com");
+  EXPECT_THAT (packed.path.segments, testing::ElementsAre ("a", "b"));
+  EXPECT_EQ (packed.query, "q=1");
+  EXPECT_EQ (packed.fragment, "f");
+  EXPECT_EQ (packed.scheme->data (), store.data ());
+}
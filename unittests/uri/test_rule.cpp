@@ -12,6 +12,8 @@
 //===----------------------------------------------------------------------===//
 #include <gmock/gmock.h>
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,11 +22,13 @@
 using namespace std::string_literals;
 
 using testing::ElementsAre;
+using uri::acceptor_log;
 using uri::char_range;
 using uri::rule;
 using uri::single_char;
 
 struct Rule : public testing::Test {
+  acceptor_log log;
   std::vector<std::string> output;
 
   auto remember () {
@@ -34,7 +38,7 @@ struct Rule : public testing::Test {
 // NOLINTNEXTLINE
 TEST_F (Rule, Concat) {
   bool const ok =
-    rule ("ab")
+    rule ("ab", log)
       .concat ([] (rule const& r) { return r.single_char ('a'); }, remember ())
       .concat ([] (rule const& r) { return r.single_char ('b'); }, remember ())
       .done ();
@@ -44,7 +48,7 @@ TEST_F (Rule, Concat) {
 // NOLINTNEXTLINE
 TEST_F (Rule, ConcatAcceptorOrder) {
   bool const ok =
-    rule ("ab")
+    rule ("ab", log)
       .concat (
         [this] (rule const& r) {
           return r
@@ -64,7 +68,7 @@ TEST_F (Rule, ConcatAcceptorOrder) {
 // NOLINTNEXTLINE
 TEST_F (Rule, FirstAlternative) {
   bool const ok =
-    rule ("ab")
+    rule ("ab", log)
       .concat (single_char ('a'), remember ())
       .alternative (
         [this] (rule const& r) {
@@ -80,7 +84,7 @@ TEST_F (Rule, FirstAlternative) {
 // NOLINTNEXTLINE
 TEST_F (Rule, SecondAlternative) {
   bool const ok =
-    rule ("ac")
+    rule ("ac", log)
       .concat (single_char ('a'), remember ())
       .alternative (
         [this] (rule const& r) {
@@ -96,7 +100,7 @@ TEST_F (Rule, SecondAlternative) {
 // NOLINTNEXTLINE
 TEST_F (Rule, AlternativeFail) {
   bool const ok =
-    rule ("ad")
+    rule ("ad", log)
       .concat (single_char ('a'), remember ())
       .alternative (
         [this] (rule const& r) {
@@ -112,7 +116,7 @@ TEST_F (Rule, AlternativeFail) {
 // NOLINTNEXTLINE
 TEST_F (Rule, Star) {
   bool const ok =
-    rule ("aaa")
+    rule ("aaa", log)
       .star ([this] (rule const& r) {
         return r.concat (single_char ('a'), remember ()).matched ("a", r);
       })
@@ -123,7 +127,7 @@ TEST_F (Rule, Star) {
 // NOLINTNEXTLINE
 TEST_F (Rule, StarConcat) {
   bool const ok =
-    rule ("aaab")
+    rule ("aaab", log)
       .star ([this] (rule const& r) {
         return r.concat (single_char ('a'), remember ()).matched ("a", r);
       })
@@ -135,7 +139,7 @@ TEST_F (Rule, StarConcat) {
 // NOLINTNEXTLINE
 TEST_F (Rule, Star2) {
   bool const ok =
-    rule ("/")
+    rule ("/", log)
       .star ([this] (rule const& r1) {
         return r1.concat (single_char ('/'), remember ())
           .concat (
@@ -151,7 +155,7 @@ TEST_F (Rule, Star2) {
 }
 // NOLINTNEXTLINE
 TEST_F (Rule, OptionalPresent) {
-  bool const ok = rule ("abc")
+  bool const ok = rule ("abc", log)
                     .concat (single_char ('a'), remember ())
                     .optional (single_char ('b'), remember ())
                     .concat (single_char ('c'), remember ())
@@ -161,7 +165,7 @@ TEST_F (Rule, OptionalPresent) {
 }
 // NOLINTNEXTLINE
 TEST_F (Rule, OptionalNotPresent) {
-  bool const ok = rule ("ac")
+  bool const ok = rule ("ac", log)
                     .concat (single_char ('a'), remember ())
                     .optional (single_char ('b'), remember ())
                     .concat (single_char ('c'), remember ())
@@ -169,3 +173,97 @@ TEST_F (Rule, OptionalNotPresent) {
   EXPECT_TRUE (ok);
   EXPECT_THAT (output, ElementsAre ("a", "c"));
 }
+// NOLINTNEXTLINE
+TEST_F (Rule, AlternativeRollsBackAcceptors) {
+  // The first alternative matches 'a' (recording an acceptor) before failing
+  // on 'b'. Its acceptor must not be run.
+  bool const ok = rule ("ac", log)
+                    .alternative (
+                      [this] (rule const& r) {
+                        return r.concat (single_char ('a'), remember ())
+                          .concat (single_char ('b'), remember ())
+                          .matched ("ab", r);
+                      },
+                      [this] (rule const& r) {
+                        return r.concat (single_char ('a'), [this] (std::string_view str) {
+                                  output.push_back ("second "s + std::string{str});
+                                })
+                          .concat (single_char ('c'), remember ())
+                          .matched ("ac", r);
+                      })
+                    .done ();
+  EXPECT_TRUE (ok);
+  EXPECT_THAT (output, ElementsAre ("second a", "c"));
+}
+// NOLINTNEXTLINE
+TEST (RuleLog, InlineCapacityDoesNotAllocate) {
+  // The null memory resource throws if it is asked for memory so this proves
+  // that the log's inline storage is sufficient.
+  acceptor_log log{std::pmr::null_memory_resource ()};
+  std::string const input (acceptor_log::inline_capacity, 'a');
+  auto count = std::size_t{0};
+  bool const ok = rule (input, log)
+                    .star ([&count] (rule const& r) {
+                      return r.concat (single_char ('a'), [&count] (std::string_view) { ++count; }).matched ("a", r);
+                    })
+                    .done ();
+  EXPECT_TRUE (ok);
+  EXPECT_EQ (count, acceptor_log::inline_capacity);
+}
+// NOLINTNEXTLINE
+TEST (RuleLog, AcceptorIsTriviallyCopyable) {
+  static_assert (std::is_trivially_copyable_v<acceptor_log::acceptor>);
+  static_assert (sizeof (acceptor_log::acceptor) == 2 * sizeof (void*));
+  static_assert (std::is_trivially_copyable_v<acceptor_log::value_type>);
+}
+// NOLINTNEXTLINE
+TEST (RuleLog, LargeAcceptor) {
+  // An acceptor which is too large to be stored inline is copied to the log.
+  acceptor_log log;
+  std::string a;
+  std::string b;
+  std::string c;
+  auto const append = [&a, &b, &c] (std::string_view const str) {
+    a += str;
+    b += str;
+    c += str;
+  };
+  static_assert (sizeof (append) > sizeof (void*));
+  bool const ok = rule ("ab", log)
+                    .concat ([&append] (rule const& r) {
+                      // The acceptor passed here is a temporary which no
+                      // longer exists when done() runs the acceptors.
+                      return r.concat (single_char ('a'), decltype (append){append}).matched ("a", r);
+                    })
+                    .concat (single_char ('b'), append)
+                    .done ();
+  EXPECT_TRUE (ok);
+  EXPECT_EQ (a, "ab");
+  EXPECT_EQ (b, "ab");
+  EXPECT_EQ (c, "ab");
+}
+// NOLINTNEXTLINE
+TEST (RuleLog, OwningAcceptors) {
+  // Acceptors which own resources (here a std::string and a std::function) are
+  // kept alive until the log is destroyed.
+  auto const token = std::make_shared<int> (0);
+  std::string out;
+  {
+    acceptor_log log;
+    std::string const prefix = "<";
+    std::function<void (std::string_view)> const suffix = [&out, token] (std::string_view const str) {
+      out += str;
+      out += '>';
+    };
+    bool const ok = rule ("ab", log)
+                      .concat (single_char ('a'),
+                               [&out, prefix] (std::string_view const str) { out += prefix + std::string{str}; })
+                      .concat (single_char ('b'), suffix)
+                      .done ();
+    EXPECT_TRUE (ok);
+    EXPECT_EQ (out, "<ab>");
+    EXPECT_GT (token.use_count (), 2);
+  }
+  // The log has destroyed its copy of the std::function.
+  EXPECT_EQ (token.use_count (), 1);
+}
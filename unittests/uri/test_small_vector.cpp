@@ -0,0 +1,148 @@
+//===- unittests/uri/test_small_vector.cpp --------------------------------===//
+//*                      _ _                  _              *
+//*  ___ _ __ ___   __ _| | | __   _____  ___| |_ ___  _ __  *
+//* / __| '_ ` _ \ / _` | | | \ \ / / _ \/ __| __/ _ \| '__| *
+//* \__ \ | | | | | (_| | | |  \ V /  __/ (__| || (_) | |    *
+//* |___/_| |_| |_|\__,_|_|_|   \_/ \___|\___|\__\___/|_|    *
+//*                                                          *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <array>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "uri/small_vector.hpp"
+
+using testing::ElementsAre;
+using sv4 = uri::small_vector<int, 4>;
+
+// NOLINTNEXTLINE
+TEST (SmallVector, Empty) {
+  sv4 v;
+  EXPECT_TRUE (v.empty ());
+  EXPECT_EQ (v.size (), 0U);
+  EXPECT_EQ (v.capacity (), 4U);
+  EXPECT_TRUE (v.is_inline ());
+  EXPECT_EQ (v.begin (), v.end ());
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, InlineThenHeap) {
+  sv4 v;
+  for (auto i = 0; i < 4; ++i) {
+    v.push_back (i);
+  }
+  EXPECT_TRUE (v.is_inline ());
+  EXPECT_THAT (v, ElementsAre (0, 1, 2, 3));
+  v.emplace_back (4);
+  EXPECT_FALSE (v.is_inline ());
+  EXPECT_GE (v.capacity (), 5U);
+  EXPECT_THAT (v, ElementsAre (0, 1, 2, 3, 4));
+  EXPECT_EQ (v.front (), 0);
+  EXPECT_EQ (v.back (), 4);
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, PushBackOwnElement) {
+  sv4 v{1, 2, 3, 4};
+  v.push_back (v.front ());  // Reallocates while referring to an element.
+  EXPECT_THAT (v, ElementsAre (1, 2, 3, 4, 1));
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, CopyAndMove) {
+  sv4 const small{1, 2};
+  sv4 const large{1, 2, 3, 4, 5, 6};
+  for (auto const* const src : {&small, &large}) {
+    sv4 copy = *src;
+    EXPECT_EQ (copy, *src);
+    sv4 moved = std::move (copy);
+    EXPECT_EQ (moved, *src);
+    EXPECT_TRUE (copy.empty ());  // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ (moved.is_inline (), src->is_inline ());
+
+    sv4 assigned{9};
+    assigned = moved;
+    EXPECT_EQ (assigned, *src);
+    sv4 move_assigned{1, 2, 3, 4, 5, 6, 7, 8};
+    move_assigned = std::move (assigned);
+    EXPECT_EQ (move_assigned, *src);
+  }
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, Erase) {
+  sv4 v{1, 2, 3, 4, 5};
+  auto const it = v.erase (v.begin () + 1, v.begin () + 3);
+  EXPECT_EQ (*it, 4);
+  EXPECT_THAT (v, ElementsAre (1, 4, 5));
+  v.erase (v.begin ());
+  EXPECT_THAT (v, ElementsAre (4, 5));
+  v.pop_back ();
+  EXPECT_THAT (v, ElementsAre (4));
+  v.clear ();
+  EXPECT_TRUE (v.empty ());
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, Resize) {
+  sv4 v{1};
+  v.resize (3, 7);
+  EXPECT_THAT (v, ElementsAre (1, 7, 7));
+  v.resize (6);
+  EXPECT_THAT (v, ElementsAre (1, 7, 7, 0, 0, 0));
+  v.resize (2);
+  EXPECT_THAT (v, ElementsAre (1, 7));
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, TooLarge) {
+  sv4 v{1, 2};
+  auto const too_large = sv4::max_size () + 1U;
+  EXPECT_THROW (v.reserve (too_large), std::length_error);
+  EXPECT_THROW (v.resize (too_large), std::length_error);
+  // The vector is unchanged.
+  EXPECT_THAT (v, ElementsAre (1, 2));
+  EXPECT_TRUE (v.is_inline ());
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, BackInserter) {
+  std::vector<int> const src{1, 2, 3, 4, 5, 6};
+  sv4 v;
+  std::copy (src.begin (), src.end (), std::back_inserter (v));
+  EXPECT_THAT (v, ElementsAre (1, 2, 3, 4, 5, 6));
+  EXPECT_THAT (sv4 (v.rbegin (), v.rend ()), ElementsAre (6, 5, 4, 3, 2, 1));
+}
+// NOLINTNEXTLINE
+TEST (SmallVector, PolymorphicAllocator) {
+  using pmr_vector = uri::small_vector<int, 2, std::pmr::polymorphic_allocator<int>>;
+  std::array<std::byte, 256> buffer1{};
+  std::pmr::monotonic_buffer_resource r1{buffer1.data (), buffer1.size (), std::pmr::null_memory_resource ()};
+  std::array<std::byte, 256> buffer2{};
+  std::pmr::monotonic_buffer_resource r2{buffer2.data (), buffer2.size (), std::pmr::null_memory_resource ()};
+
+  pmr_vector a{{1, 2, 3}, &r1};
+  EXPECT_EQ (a.get_allocator ().resource (), &r1);
+  EXPECT_FALSE (a.is_inline ());
+
+  // Copy construction uses the default resource, as for std::pmr::vector.
+  pmr_vector const copy = a;
+  EXPECT_EQ (copy.get_allocator ().resource (), std::pmr::get_default_resource ());
+
+  // Move construction takes the allocator and the storage.
+  auto const* const data = a.data ();
+  pmr_vector b = std::move (a);
+  EXPECT_EQ (b.get_allocator ().resource (), &r1);
+  EXPECT_EQ (b.data (), data);
+
+  // Assignment does not propagate the allocator: the elements are copied.
+  pmr_vector c{&r2};
+  c = std::move (b);
+  EXPECT_EQ (c.get_allocator ().resource (), &r2);
+  EXPECT_NE (c.data (), data);
+  EXPECT_THAT (c, ElementsAre (1, 2, 3));
+  c = copy;
+  EXPECT_EQ (c.get_allocator ().resource (), &r2);
+  EXPECT_THAT (c, ElementsAre (1, 2, 3));
+}
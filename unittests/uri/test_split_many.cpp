@@ -0,0 +1,101 @@
+//===- unittests/uri/test_split_many.cpp ----------------------------------===//
+//*            _ _ _                                  *
+//*  ___ _ __ | (_) |_   _ __ ___   __ _ _ __  _   _  *
+//* / __| '_ \| | | __| | '_ ` _ \ / _` | '_ \| | | | *
+//* \__ \ |_) | | | |_  | | | | | | (_| | | | | |_| | *
+//* |___/ .__/|_|_|\__| |_| |_| |_|\__,_|_| |_|\__, | *
+//*     |_|                                    |___/  *
+//===----------------------------------------------------------------------===//
+// Distributed under the MIT License.
+// See https://github.com/paulhuggett/uri/blob/main/LICENSE for information.
+// SPDX-License-Identifier: MIT
+//===----------------------------------------------------------------------===//
+#include <gmock/gmock.h>
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "uri/split_many.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+constexpr std::array inputs{
+    "http://user@example.com:8080/a/b/c?q=1#frag"sv,
+    "not a uri"sv,
+    "mailto:John.Doe@example.com"sv,
+    "../a/b/c?q#f"sv,
+    "http://[2001:db8::7]/a"sv,
+    ""sv,
+    "http://example.com/a/b/c/d/e/f/g/h/i/j/k"sv,
+    "//host"sv,
+};
+
+}  // end anonymous namespace
+
+// NOLINTNEXTLINE
+TEST (SplitMany, MatchesSplit) {
+  uri::split_columns columns;
+  uri::split_many (inputs, columns);
+  ASSERT_EQ (columns.size (), inputs.size ());
+  for (auto row = std::size_t{0}; row < inputs.size (); ++row) {
+    SCOPED_TRACE (inputs[row]);
+    auto const expected = uri::split (inputs[row]);
+    EXPECT_EQ (columns.valid (row), expected.has_value ());
+    EXPECT_EQ (columns.row (row, inputs[row]), expected);
+  }
+}
+// NOLINTNEXTLINE
+TEST (SplitMany, MatchesSplitReference) {
+  uri::split_columns columns;
+  uri::split_reference_many (inputs, columns);
+  ASSERT_EQ (columns.size (), inputs.size ());
+  for (auto row = std::size_t{0}; row < inputs.size (); ++row) {
+    SCOPED_TRACE (inputs[row]);
+    auto const expected = uri::split_reference (inputs[row]);
+    EXPECT_EQ (columns.valid (row), expected.has_value ());
+    EXPECT_EQ (columns.row (row, inputs[row]), expected);
+    if (expected) {
+      EXPECT_EQ (columns.absolute (row), expected->path.absolute);
+    }
+  }
+}
+// NOLINTNEXTLINE
+TEST (SplitMany, Columns) {
+  uri::split_columns columns;
+  uri::split_many (inputs, columns);
+  auto const& in = inputs[0];
+  EXPECT_EQ (columns.scheme[0].view (in), "http");
+  EXPECT_EQ (columns.host[0].view (in), "example.com");
+  EXPECT_EQ (columns.port[0].view (in), "8080");
+  EXPECT_EQ (columns.path[0].view (in), "a/b/c");
+  EXPECT_EQ (columns.query[0].view (in), "q=1");
+  EXPECT_EQ (columns.fragment[0].view (in), "frag");
+  // Every range of an invalid row is absent.
+  EXPECT_FALSE (columns.valid (1));
+  EXPECT_EQ (columns.compact_row (1), uri::compact_parts{});
+}
+// NOLINTNEXTLINE
+TEST (SplitMany, Bitmap) {
+  // Enough rows to need more than one word of the bitmap.
+  std::vector<std::string> storage;
+  for (auto i = 0U; i < 150U; ++i) {
+    storage.push_back (i % 3U == 0U ? "bad uri" : "http://h/" + std::to_string (i));
+  }
+  std::vector<std::string_view> const views (storage.begin (), storage.end ());
+  uri::split_columns columns;
+  uri::split_many (views, columns);
+  ASSERT_EQ (columns.size (), 150U);
+  EXPECT_EQ (columns.valid_bits.size (), 3U);
+  for (auto i = std::size_t{0}; i < views.size (); ++i) {
+    EXPECT_EQ (columns.valid (i), i % 3U != 0U) << "row " << i;
+  }
+
+  // A second call replaces the previous results.
+  uri::split_many (std::span<std::string_view const>{views}.first (2), columns);
+  EXPECT_EQ (columns.size (), 2U);
+  EXPECT_EQ (columns.valid_bits.size (), 1U);
+}